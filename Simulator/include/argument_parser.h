@@ -0,0 +1,26 @@
+#ifndef ARGUMENT_PARSER_H
+#define ARGUMENT_PARSER_H
+
+#include "simulator_periodic.h"
+#include <string>
+#include <vector>
+
+// Number of positional arguments of a simulation with periodic boundary conditions
+#define PERIODIC_ARGUMENT_COUNT 8
+
+// Parses <street_length> <initial_cars> <vmax> <iterations> <dawdle_probability> <always_unlimited> <start_velocity_zero> <multicore>
+// and checks the validity of the values. Returns an empty string on success, otherwise the error message.
+// The output file name is not touched and has to be set by the caller.
+std::string parse_periodic_arguments(const std::vector<std::string> &arguments, PeriodicParameters &parameters);
+
+// Checks the values of the positional arguments, also used for parameters that do not come from the command line.
+// Returns an empty string on success, otherwise the error message.
+std::string validate_periodic_parameters(const PeriodicParameters &parameters);
+
+// Parses the optional arguments --time-stride=<n> --window=<start>:<end> --space-stride=<n> --aggregate=<min|mean|max>
+// --image=<file.pgm|file.ppm> --no-csv --engine=<cells|car_list|auto> --threads=<n>
+// --jams[=<file>] --jam-speed=<n> --jam-gap=<n> --jam-cars=<n> --seed=<n> --keyframes=<n> --keyframe-file=<file> --fleet=<file> and checks them against the already parsed street length.
+// Returns an empty string on success, otherwise the error message.
+std::string parse_options(const std::vector<std::string> &options, PeriodicParameters &parameters);
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef AUTOTUNER_H
+#define AUTOTUNER_H
+
+#include "simulator_periodic.h"
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Engine and number of threads a simulation is performed with
+struct EngineChoice
+{
+    Engine engine;
+    int threads;
+};
+
+/*
+Chooses the fastest engine and number of threads for the parameters of a simulation.
+The candidates are measured with a short calibration run without output, the winner is cached per
+machine and parameter bucket (street length, density, speed limit) in a local file, so the
+calibration only runs once per bucket.
+*/
+class Autotuner
+{
+
+// ##################################################################### //
+// ############################# VARIABLES ############################# //
+// ##################################################################### //
+
+private:
+    std::filesystem::path cache_file_name;
+    // guards the cache file, the server tunes the jobs of several workers with one autotuner
+    std::mutex mutex;
+
+// ##################################################################### //
+// ############################ CONSTRUCTORS ########################### //
+// ##################################################################### //
+
+public:
+    explicit Autotuner(const std::filesystem::path &cache_file_name);
+
+// ##################################################################### //
+// ############################## METHODS ############################## //
+// ##################################################################### //
+
+public:
+    // Method to replace Engine::AUTO by the fastest engine, sets engine, multicore, threads and engine_report
+    void tune(PeriodicParameters &parameters);
+    // Method to get the cache file next to the executable
+    static std::filesystem::path default_cache_file();
+    static std::string describe(const EngineChoice &choice);
+
+private:
+    std::vector<EngineChoice> candidates(const PeriodicParameters &parameters);
+    double measure(const PeriodicParameters &parameters, const EngineChoice &choice);
+    std::string bucket(const PeriodicParameters &parameters);
+    bool load(const std::string &key, EngineChoice &choice, std::string &report);
+    void store(const std::string &key, const EngineChoice &choice, const std::string &report);
+};
+
+#endif
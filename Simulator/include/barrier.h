@@ -0,0 +1,39 @@
+#ifndef BARRIER_H
+#define BARRIER_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+// Reusable barrier to synchronize the threads of the multicore simulation after every step phase
+class Barrier
+{
+
+// ##################################################################### //
+// ############################# VARIABLES ############################# //
+// ##################################################################### //
+
+private:
+    std::mutex mutex;
+    std::condition_variable released;
+    const int thread_count;
+    int waiting = 0;
+    unsigned long generation = 0;
+
+// ##################################################################### //
+// ############################ CONSTRUCTORS ########################### //
+// ##################################################################### //
+
+public:
+    explicit Barrier(int thread_count);
+
+// ##################################################################### //
+// ############################## METHODS ############################## //
+// ##################################################################### //
+
+public:
+    // Blocks until all threads arrived, the last arriving thread runs the completion before the others are released
+    void arrive_and_wait(const std::function<void()> &completion = nullptr);
+};
+
+#endif
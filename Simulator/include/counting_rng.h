@@ -0,0 +1,61 @@
+#ifndef COUNTING_RNG_H
+#define COUNTING_RNG_H
+
+#include <random>
+
+/*
+Random number generator of the simulation, a mt19937 that counts the numbers it generated. The state of
+a generator seeded with a number is then described by the seed and the count, so a keyframe stores
+8 bytes instead of the 2.5 KB of the mt19937 state. Restoring a state discards count numbers, which
+takes time proportional to the count but is still much faster than simulating the steps again.
+*/
+class CountingRng
+{
+
+// ##################################################################### //
+// ############################# VARIABLES ############################# //
+// ##################################################################### //
+
+private:
+    std::mt19937 engine;
+    unsigned long long count = 0;
+
+// ##################################################################### //
+// ############################ CONSTRUCTORS ########################### //
+// ##################################################################### //
+
+public:
+    using result_type = std::mt19937::result_type;
+
+    CountingRng() = default;
+    // Constructor for the generators of the threads, their state can not be restored from a seed
+    explicit CountingRng(std::seed_seq &sequence) : engine(sequence) {}
+
+// ##################################################################### //
+// ############################## METHODS ############################## //
+// ##################################################################### //
+
+public:
+    static constexpr result_type min() { return std::mt19937::min(); }
+    static constexpr result_type max() { return std::mt19937::max(); }
+    result_type operator()()
+    {
+        count++;
+        return engine();
+    }
+    void seed(unsigned int seed)
+    {
+        engine.seed(seed);
+        count = 0;
+    }
+    // Method to restore the state after count numbers were generated with the given seed
+    void restore(unsigned int seed, unsigned long long count)
+    {
+        engine.seed(seed);
+        engine.discard(count);
+        this->count = count;
+    }
+    unsigned long long get_count() const { return count; }
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef FLEET_H
+#define FLEET_H
+
+#include "counting_rng.h"
+#include <string>
+#include <vector>
+
+// Number of vehicle classes a fleet can have, the class of a vehicle is stored in one byte
+#define MAX_VEHICLE_CLASSES 256
+
+// Struct to store a vehicle class as it is given in the fleet file
+struct VehicleClass
+{
+    std::string name;
+    // relative frequency of the class, the shares of a fleet do not have to add up to 1
+    double share;
+    int max_speed;
+    // -1 to use the dawdle probability of the simulation
+    float dawdle_probability;
+    // speed gained per step
+    int acceleration;
+    // number of cells the vehicle occupies, the position of a vehicle is the cell of its front
+    int length;
+};
+
+// Parameters of a vehicle class read by the update kernels, small enough that the whole table stays in the L1 cache
+struct ClassParameters
+{
+    int max_speed, acceleration, length;
+    float dawdle_probability;
+};
+
+/*
+Table of the vehicle classes of a simulation. The cars only store the index of their class, so the
+kernels read the parameters of all cars from this table instead of the cars themselves.
+*/
+class Fleet
+{
+
+// ##################################################################### //
+// ############################# VARIABLES ############################# //
+// ##################################################################### //
+
+private:
+    std::vector<ClassParameters> table;
+    // shares of the classes summed up and normalized to 1
+    std::vector<double> cumulative_shares;
+    int max_speed = 0, max_length = 1;
+
+// ##################################################################### //
+// ############################ CONSTRUCTORS ########################### //
+// ##################################################################### //
+
+public:
+    Fleet() = default;
+    explicit Fleet(const std::vector<VehicleClass> &classes);
+
+// ##################################################################### //
+// ############################## METHODS ############################## //
+// ##################################################################### //
+
+public:
+    const ClassParameters &operator[](unsigned char vehicle_class) const { return table[vehicle_class]; }
+    const ClassParameters *data() const { return table.data(); }
+    int size() const { return table.size(); }
+    int get_max_speed() const { return max_speed; }
+    int get_max_length() const { return max_length; }
+    // Method to draw the class of a new vehicle according to the shares
+    unsigned char draw(CountingRng &rng) const;
+
+    // Method to read the classes from a fleet file
+    static std::vector<VehicleClass> load(const std::string &file_name);
+    // Method to get the classes of the fleet described by the positional arguments (vmax, always_unlimited)
+    static std::vector<VehicleClass> default_classes(bool always_unlimited, int vmax);
+    // Method to check the values of a class, returns an empty string if they are valid
+    static std::string validate(const VehicleClass &vehicle_class);
+};
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef JAM_TRACKER_H
+#define JAM_TRACKER_H
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+// Struct to store when cars count as a jam and where the jam statistics are written to
+struct JamOptions
+{
+    bool enabled = false;
+    // cars with a speed up to max_speed are slow
+    int max_speed = 0;
+    // number of free cells allowed between two slow cars of the same jam
+    int max_gap = 0;
+    // minimal number of cars of a jam
+    int min_cars = 2;
+    // file for the events and histograms, empty to derive it from the output file name
+    std::string file_name;
+};
+
+/*
+Detects jams after every step and follows them over time. A jam is a group of consecutive slow cars,
+it is linked to the jam of the previous step whose cells it overlaps. Only the cells of the jams are
+touched, so a step costs O(cars) and not O(street length).
+Birth and death events are written while the simulation runs, the histograms of the jam length,
+lifetime and propagation speed when it is finished.
+*/
+class JamTracker
+{
+
+// ##################################################################### //
+// ############################# VARIABLES ############################# //
+// ##################################################################### //
+
+private:
+    // A group of consecutive slow cars, tail is the position of the last car, head the position of the first one
+    struct Cluster
+    {
+        int tail, head, cars;
+    };
+    // A jam that is followed over time
+    struct Jam
+    {
+        int id, birth, tail, head, cars, max_cars;
+        // distance the head moved since the birth, negative if the jam moves backwards
+        long long displacement;
+    };
+
+    JamOptions options;
+    int street_length;
+    std::ofstream file;
+    int next_id = 0;
+    std::vector<Jam> jams;
+    // index of the jam in jams that covers a cell, -1 if the cell is not part of a jam
+    std::vector<int> owner;
+    // buffers reused every step
+    std::vector<Cluster> clusters;
+    std::vector<Jam> next_jams;
+    // new cluster continuing every old jam, which clusters overlap an old jam and which old jam a cluster inherits
+    std::vector<int> winner, inherited;
+    std::vector<bool> overlapping;
+
+    // statistics
+    int last_step = 0;
+    long long steps = 0, alive_sum = 0;
+    int max_alive = 0, open_at_end = 0;
+    std::map<int, int> length_histogram, lifetime_histogram, speed_histogram;
+
+// ##################################################################### //
+// ###################### CONSTRUCTOR & DESTRUCTOR ##################### //
+// ##################################################################### //
+
+public:
+    JamTracker(const JamOptions &options, int street_length);
+
+// ##################################################################### //
+// ############################## METHODS ############################## //
+// ##################################################################### //
+
+public:
+    // Method to process the state after a step, the cars have to be ordered by their position
+    void observe(int step, const std::vector<int> &positions, const std::vector<int> &speeds, const std::vector<int> &lengths);
+    // Method to close the jams that are still open and write the histograms
+    void finish();
+
+private:
+    void find_clusters(const std::vector<int> &positions, const std::vector<int> &speeds, const std::vector<int> &lengths);
+    void mark(const Jam &jam, int index);
+    void write_event(const char *event, int step, const Jam &jam, const char *reason);
+    void close_jam(int step, const Jam &jam, const char *reason);
+    void write_histogram(const char *quantity, const std::map<int, int> &histogram, bool logarithmic, float bin_width);
+};
+
+#endif
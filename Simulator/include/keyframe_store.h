@@ -0,0 +1,79 @@
+#ifndef KEYFRAME_STORE_H
+#define KEYFRAME_STORE_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+struct PeriodicParameters;
+
+// Struct to store how often keyframes are recorded
+struct KeyframeOptions
+{
+    // a keyframe is written every interval steps, 0 disables the keyframes
+    int interval = 0;
+    // file for the keyframes, empty to derive it from the output file name
+    std::string file_name;
+};
+
+// State of the simulation after a step, enough to continue the simulation exactly
+struct Keyframe
+{
+    int step;
+    // numbers drawn from the random number generator since it was seeded
+    unsigned long long rng_count;
+    // the cars in the order of their position
+    std::vector<int> positions, speeds, vehicle_classes;
+};
+
+/*
+File of keyframes written every interval steps. The step kernels are deterministic for a given
+random number generator state, so any step can be restored exactly by loading the nearest keyframe
+before it and simulating forward. The generator state is the seed, stored once in the parameters,
+and the count of numbers drawn since seeding (see CountingRng). All keyframes have the same size
+(the number of cars is constant with periodic boundaries), so a keyframe is found by its offset without an index.
+Layout: one text line with the parameters and the vehicle classes, followed by the binary keyframes
+    int32 step | uint64 rng count | per car: int32 position, int32 speed, uint8 vehicle class
+*/
+class KeyframeStore
+{
+
+// ##################################################################### //
+// ############################# VARIABLES ############################# //
+// ##################################################################### //
+
+private:
+    std::fstream file;
+    int car_count, interval;
+    unsigned int seed;
+    std::streamoff header_size;
+    std::string parameter_line;
+
+// ##################################################################### //
+// ############################ CONSTRUCTORS ########################### //
+// ##################################################################### //
+
+public:
+    // Constructor to create a new file for a simulation
+    KeyframeStore(const std::string &file_name, const PeriodicParameters &parameters, unsigned int seed, int interval);
+    // Constructor to open an existing file for reading
+    explicit KeyframeStore(const std::string &file_name);
+
+// ##################################################################### //
+// ############################## METHODS ############################## //
+// ##################################################################### //
+
+public:
+    void write(const Keyframe &keyframe);
+    // Method to read the last keyframe at or before the given step
+    Keyframe read_nearest(int step);
+    // Method to get the parameters of the recorded simulation (without output settings)
+    PeriodicParameters parameters() const;
+    int get_interval() const;
+    int count();
+
+private:
+    std::streamoff record_size() const;
+};
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef NASCH_H
+#define NASCH_H
+
+/*
+C interface of the simulator (libnasch) to drive simulations in-process, e.g. from Python with ctypes.
+Every struct starts with struct_size, the caller sets it to sizeof the struct before passing the struct to the library.
+The structs only grow at their end, NASCH_API_VERSION is increased whenever that happens. The library only reads
+and writes the fields covered by struct_size, so callers built against an older version of this header keep working.
+All functions are safe to call from several threads as long as every simulation is used by one thread at a time.
+Functions returning int return 0 on success and -1 on error, functions returning a pointer return NULL on error,
+nasch_last_error then describes the error of the calling thread.
+*/
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define NASCH_API_VERSION 2
+
+// Handle of a simulation
+typedef struct nasch_simulation nasch_simulation;
+
+// Engines of the simulation, see the --engine option of the command line
+enum nasch_engine
+{
+    NASCH_ENGINE_CELLS = 0,
+    NASCH_ENGINE_CAR_LIST = 1,
+    NASCH_ENGINE_AUTO = 2
+};
+
+// Parameters of a simulation with periodic boundary conditions, set struct_size and initialize them with nasch_default_parameters
+typedef struct nasch_parameters
+{
+    size_t struct_size;
+    int street_length;
+    int initial_cars;
+    // max speed of all cars, -1 to draw it from the speed distribution
+    int vmax;
+    float dawdle_probability;
+    int always_unlimited;
+    int start_velocity_zero;
+    // seed of the random number generator, -1 to draw a random seed
+    long long seed;
+    // one of nasch_engine
+    int engine;
+    // threads of the cells engine, 1 for a single thread, 0 to use all cores
+    int threads;
+    // cache of the autotuner for NASCH_ENGINE_AUTO, NULL to measure the engines every time
+    const char *autotune_cache;
+    // since version 2: fleet file with the vehicle classes (see --fleet of the command line), NULL to derive them from vmax and always_unlimited
+    const char *fleet_file;
+} nasch_parameters;
+
+// Parameters of a vehicle class
+typedef struct nasch_vehicle_class
+{
+    size_t struct_size;
+    int max_speed;
+    int acceleration;
+    // number of cells, the position of a vehicle is the cell of its front
+    int length;
+    float dawdle_probability;
+} nasch_vehicle_class;
+
+/*
+Read-only view of the current state, valid until the next call of nasch_step or nasch_destroy.
+The values are not copied, they point into the state of the simulator:
+    car k:  *(const int *)((const char *)speeds + k * car_stride), the same for positions
+            *(const int *)((const char *)max_speeds + k * max_speed_stride) is the max speed of the car (version 1: car_stride)
+            *(const unsigned char *)((const char *)vehicle_classes + k * car_stride) is the class of the car
+    cell i: *(const void *const *)((const char *)cells + i * cell_stride) is not NULL if the cell is occupied,
+            a long vehicle occupies the cell of its front and the length - 1 cells behind it
+The order of the cars does not change during a simulation.
+*/
+typedef struct nasch_view
+{
+    size_t struct_size;
+    int step;
+    int street_length;
+    int car_count;
+    const int *speeds;
+    const int *positions;
+    // max speed of the class of every car, it does not change during a simulation and is read with max_speed_stride
+    const int *max_speeds;
+    ptrdiff_t car_stride;
+    const void *const *cells;
+    ptrdiff_t cell_stride;
+    // since version 2: the class of every car and the number of classes (see nasch_get_vehicle_class)
+    const unsigned char *vehicle_classes;
+    int class_count;
+    ptrdiff_t max_speed_stride;
+} nasch_view;
+
+// Observables of the current state
+typedef struct nasch_observables
+{
+    size_t struct_size;
+    int step;
+    int cars;
+    int stopped_cars;
+    // cars per cell
+    double density;
+    // mean speed of the cars in cells per step
+    double mean_speed;
+    // cars passing a cell per step (density times mean speed)
+    double flow;
+} nasch_observables;
+
+// Version of the interface the library was built with
+int nasch_api_version(void);
+// Message of the last error in the calling thread, empty if there was none
+const char *nasch_last_error(void);
+
+int nasch_default_parameters(nasch_parameters *parameters);
+// Creates a simulation and fills the street with the initial cars (step 0)
+nasch_simulation *nasch_create(const nasch_parameters *parameters);
+// Performs the next steps of the simulation
+int nasch_step(nasch_simulation *simulation, int steps);
+int nasch_get_view(const nasch_simulation *simulation, nasch_view *view);
+int nasch_get_observables(const nasch_simulation *simulation, nasch_observables *observables);
+// Gets the parameters of a vehicle class, the dawdle probability of the simulation is filled in for classes without their own
+int nasch_get_vehicle_class(const nasch_simulation *simulation, int vehicle_class, nasch_vehicle_class *parameters);
+void nasch_destroy(nasch_simulation *simulation);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef SIMULATION_SERVER_H
+#define SIMULATION_SERVER_H
+
+#include "simulator_periodic.h"
+#include "autotuner.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// State of a job submitted to the server
+enum class JobState
+{
+    QUEUED,
+    RUNNING,
+    FINISHED,
+    CANCELLED,
+    FAILED
+};
+
+// Struct to store a job and its progress, shared between the connection and the worker threads
+struct SimulationJob
+{
+    int id;
+    PeriodicParameters parameters;
+    bool inline_result;
+    std::atomic<int> finished_iterations{0};
+    std::atomic<bool> cancel_requested{false};
+    // the following members are guarded by the job mutex of the server
+    JobState state = JobState::QUEUED;
+    std::string result;
+    std::string error;
+};
+
+/*
+Long-lived simulation daemon accepting jobs over a Unix domain socket. The worker threads and their
+simulators (including the street buffers) are created once and reused for every job.
+Each request is a single line, each response starts with "OK", "ERROR" or the name of the command:
+    RUN <street_length> <initial_cars> <vmax> <iterations> <dawdle_probability> <always_unlimited> <start_velocity_zero> <multicore> [--output=<path> | --inline] [output options]
+    STATUS <job_id>     -> STATUS <job_id> <state> <finished_iterations>/<iterations>
+    WAIT <job_id>       -> blocks until the job is done, then answers like STATUS
+    RESULT <job_id>     -> RESULT <job_id> FILE <path>  or  RESULT <job_id> INLINE <bytes> followed by the csv
+    CANCEL <job_id>     -> cancels the job, a job that is already done is forgotten
+A job is forgotten after its RESULT was requested, or once MAX_RETAINED_JOBS newer jobs are done.
+The csv file of a cancelled or failed job is kept with the steps written so far, RESULT answers with an error for it.
+    SHUTDOWN
+*/
+class SimulationServer
+{
+
+// ##################################################################### //
+// ############################# VARIABLES ############################# //
+// ##################################################################### //
+
+private:
+    std::string socket_path;
+    int listen_fd = -1;
+    int thread_count;
+    std::atomic<bool> stopping{false};
+    std::string output_prefix;
+    // shared by all workers, so every parameter bucket is calibrated only once
+    std::unique_ptr<Autotuner> autotuner;
+
+    // job bookkeeping
+    std::mutex job_mutex;
+    std::condition_variable job_available;
+    std::condition_variable job_done;
+    std::deque<std::shared_ptr<SimulationJob>> queue;
+    std::map<int, std::shared_ptr<SimulationJob>> jobs;
+    // ids of the done jobs in the order they were done, used to forget results nobody fetches
+    std::deque<int> retired_jobs;
+    int next_job_id = 1;
+
+    // threads
+    std::vector<std::thread> workers;
+    std::mutex connection_mutex;
+    std::condition_variable connections_closed;
+    std::vector<int> connection_fds;
+
+// ##################################################################### //
+// ###################### CONSTRUCTOR & DESTRUCTOR ##################### //
+// ##################################################################### //
+
+public:
+    SimulationServer(const std::string &socket_path, int thread_count);
+    ~SimulationServer();
+
+// ##################################################################### //
+// ############################## METHODS ############################## //
+// ##################################################################### //
+
+public:
+    // Method to accept connections until a SHUTDOWN request arrives
+    void run();
+    void stop();
+
+private:
+    void worker_loop();
+    void handle_connection(int fd);
+    std::string handle_request(const std::string &line);
+    std::string submit_job(const std::vector<std::string> &tokens);
+    std::string describe_job(const SimulationJob &job);
+    void retire_job(const SimulationJob &job);
+    std::shared_ptr<SimulationJob> find_job(const std::string &id);
+};
+
+#endif
@@ -4,8 +4,11 @@
 #define EMPTY -1
 
 #include "car.h"
+#include "counting_rng.h"
 #include <memory>
 #include <map>
+#include <random>
+#include <vector>
 
 
 class SimulatorBase
@@ -30,7 +33,7 @@ private:
     // Pure virtual methods to be implemented by the derived classes
     virtual void accelerate_cars(std::vector<Car*> &reading_street, std::vector<Car*> &writing_street, int start_index, int end_index) = 0;
     virtual void decelerate_cars(std::vector<Car*> &reading_street, std::vector<Car*> &writing_street, int start_index, int end_index) = 0;
-    virtual void dawdle_cars(std::vector<Car*> &reading_street, std::vector<Car*> &writing_street, int start_index, int end_index, float dawdle_prob, std::mt19937 &rng) = 0;
+    virtual void dawdle_cars(std::vector<Car*> &reading_street, std::vector<Car*> &writing_street, int start_index, int end_index, float dawdle_prob, CountingRng &rng) = 0;
     virtual void move_cars(std::vector<Car*> &reading_street, std::vector<Car*> &writing_street, int start_index, int end_index) = 0;
     virtual void print_street(std::vector<Car*>& street) = 0;
     virtual void print_parameters() = 0;
@@ -2,6 +2,23 @@
 #define SIMULATOR_PERIODIC_H
 
 #include "simulator_base.h"
+#include "street_output.h"
+#include "jam_tracker.h"
+#include "keyframe_store.h"
+#include "fleet.h"
+#include "barrier.h"
+#include "worker_pool.h"
+#include <fstream>
+#include <filesystem>
+#include <functional>
+
+// Representation used to perform the simulation steps
+enum class Engine
+{
+    CELLS,    // street of cells, wins at high densities, can be split over several threads
+    CAR_LIST, // list of the cars ordered by their position, wins at low densities
+    AUTO      // chosen by the autotuner before the simulation is started
+};
 
 // Struct to store the parameters of the simulation for periodic boundaries
 struct PeriodicParameters
@@ -11,6 +28,18 @@ struct PeriodicParameters
     float dawdle_probability;
     bool always_unlimited, start_velocity_zero, multicore;
     std::string output_file_name;
+    OutputOptions output;
+    Engine engine = Engine::CELLS;
+    // number of threads of the multicore simulation, 0 to use all cores
+    int threads = 0;
+    // description of how the engine was chosen, written to the header if set
+    std::string engine_report;
+    JamOptions jams;
+    KeyframeOptions keyframes;
+    // seed of the random number generator, -1 to draw a random seed
+    long long seed = -1;
+    // classes of the vehicles, empty to derive them from vmax and always_unlimited
+    std::vector<VehicleClass> vehicle_classes;
 };
 
 class SimulatorPeriodic : public SimulatorBase
@@ -22,8 +51,44 @@ class SimulatorPeriodic : public SimulatorBase
 
 private:
     PeriodicParameters parameters;
+    // Cars of the simulation in one block, the streets point into it (a car is in every cell it occupies)
+    std::vector<Car> cars;
+    // Table of the vehicle classes the kernels read the parameters of the cars from
+    Fleet fleet;
     std::vector<Car*> reading_street;
     std::vector<Car*> writing_street;
+    // Cars ordered by their position and their positions, used by the car list engine
+    std::vector<Car*> car_list;
+    std::vector<int> car_positions;
+    // Stream the results are written to, either the opened output file or a stream set by the caller
+    std::ofstream output_file;
+    std::ostream *output_stream = nullptr;
+    std::ostream *external_output_stream = nullptr;
+    // Space-time diagram and the buffer for the decimated row written to the outputs
+    std::unique_ptr<SpaceTimeRenderer> renderer;
+    std::vector<float> output_row;
+    // Jam tracker and the buffers for the cars passed to it
+    std::unique_ptr<JamTracker> jam_tracker;
+    std::vector<int> jam_positions;
+    std::vector<int> jam_speeds;
+    std::vector<int> jam_lengths;
+    // Cars of the cells engine in their order along the street, used to pass them to the jam tracker
+    std::vector<Car*> jam_order;
+    // Random number generator of the single threaded engines, its state is part of the keyframes
+    CountingRng rng;
+    unsigned int used_seed = 0;
+    // Random number generators of the threads of the multicore engine, kept between calls of advance
+    std::vector<CountingRng> thread_rngs;
+    // Threads of the multicore engine and their barrier, kept between calls of advance
+    std::unique_ptr<WorkerPool> worker_pool;
+    std::unique_ptr<Barrier> barrier;
+    // Number of steps performed since the street was filled
+    int current_step = 0;
+    std::unique_ptr<KeyframeStore> keyframe_store;
+    Keyframe keyframe_buffer;
+    // Callback called after every iteration with the number of finished iterations, returning false cancels the run
+    std::function<bool(int)> progress_callback;
+    bool cancelled = false;
 
 // ##################################################################### //
 // ###################### CONSTRUCTOR & DESTRUCTOR ##################### //
@@ -31,6 +96,7 @@ private:
 
 public:
     SimulatorPeriodic(int street_length, int initial_cars, int vmax, int iterations, float dawdle_probability, bool always_unlimited, bool start_velocity_zero, bool multicore);
+    SimulatorPeriodic(const PeriodicParameters &parameters);
     ~SimulatorPeriodic();
 // ##################################################################### //
 // ############################## METHODS ############################## //
@@ -40,15 +106,52 @@ public:
     void perform_simulation() override;
     void perform_simulation_singlecore() override;
     void perform_simulation_multicore() override;
+    void perform_simulation_car_list();
+    void perform_replay(KeyframeStore &store, int first_step, int last_step);
+    // Methods to perform the simulation step by step without output (used by the library interface)
+    void initialize_simulation();
+    void advance(int steps);
+    int get_step() const;
+    const std::vector<Car> &get_cars() const;
+    const std::vector<Car*> &get_street() const;
+    const PeriodicParameters &get_parameters() const;
+    const Fleet &get_fleet() const;
+    // Methods to reuse the simulator (and its street buffers) for another run
+    void reset(const PeriodicParameters &parameters);
+    void set_output_stream(std::ostream *stream);
+    void set_progress_callback(std::function<bool(int)> callback);
+    bool was_cancelled() const;
+    // Methods to locate the output directory and generate unique output file names
+    static std::filesystem::path output_directory();
+    static std::string default_output_file_name();
+    static std::string reserve_output_file_name(const std::string &stem);
 
 private:
     // Methods to perform simulation steps and print results to file
     void accelerate_cars(std::vector<Car*> &reading_street, std::vector<Car*> &writing_street, int start_index, int end_index) override;
     void decelerate_cars(std::vector<Car*> &reading_street, std::vector<Car*> &writing_street, int start_index, int end_index) override;
-    void dawdle_cars(std::vector<Car*> &reading_street, std::vector<Car*> &writing_street, int start_index, int end_index, float dawdle_prob, std::mt19937 &rng) override;
+    void dawdle_cars(std::vector<Car*> &reading_street, std::vector<Car*> &writing_street, int start_index, int end_index, float dawdle_prob, CountingRng &rng) override;
     void move_cars(std::vector<Car*> &reading_street, std::vector<Car*> &writing_street, int start_index, int end_index) override;
+    void step_cells();
+    void swap_streets();
+    void step_car_list(CountingRng &rng);
+    void run_cells(int steps);
+    void run_multicore(int steps);
+    void run_car_list(int steps);
+    void build_car_list();
+    bool finish_step(int finished_iterations);
     void print_street(std::vector<Car*>& street) override;
     void print_parameters() override; 
+    void open_output();
+    void begin_output();
+    void track_jams(int step);
+    void seed_rng();
+    void build_fleet();
+    void save_keyframe(int step);
+    void restore_keyframe(const Keyframe &keyframe);
+    void close_output();
+    void decimate_street(std::vector<Car*> &street);
+    void clear_streets();
     // Methods to initialize the street
     void initialize_street() override;
     void fill_street(std::vector<Car*> &street);
@@ -0,0 +1,71 @@
+#ifndef STREET_OUTPUT_H
+#define STREET_OUTPUT_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+// How the cells of a spatial block are combined into one output value
+enum class Aggregation
+{
+    MIN,
+    MEAN,
+    MAX
+};
+
+// Struct to store how the street is written to the output file(s)
+struct OutputOptions
+{
+    // only every time_stride-th step is written (the initial state is always written)
+    int time_stride = 1;
+    // section of the street [window_start, window_end) that is written, -1 marks the end of the street
+    int window_start = 0;
+    int window_end = -1;
+    // number of neighbouring cells combined into one output value
+    int space_stride = 1;
+    Aggregation aggregation = Aggregation::MEAN;
+    // write the csv file (can be disabled if only the image is needed)
+    bool csv = true;
+    // space-time diagram written as .pgm (grayscale) or .ppm (color), empty to disable
+    std::string image_file_name;
+};
+
+/*
+Writes the space-time diagram directly to a binary PGM/PPM image while the rows are produced.
+Only one row is kept in memory, the height has to be known in advance since it is part of the header.
+Empty cells are white, cars are drawn from dark/red (standing) to light/green (max speed).
+*/
+class SpaceTimeRenderer
+{
+
+// ##################################################################### //
+// ############################# VARIABLES ############################# //
+// ##################################################################### //
+
+private:
+    std::ofstream file;
+    bool color;
+    int width, height, rows_written = 0;
+    float max_speed;
+    std::vector<unsigned char> pixels;
+
+// ##################################################################### //
+// ###################### CONSTRUCTOR & DESTRUCTOR ##################### //
+// ##################################################################### //
+
+public:
+    SpaceTimeRenderer(const std::string &file_name, int width, int height, int max_speed);
+    ~SpaceTimeRenderer();
+
+// ##################################################################### //
+// ############################## METHODS ############################## //
+// ##################################################################### //
+
+public:
+    // Method to append one row, EMPTY values are drawn as empty cells
+    void write_row(const std::vector<float> &row);
+    // Method to fill the missing rows (e.g. of a cancelled run) with empty cells and close the file
+    void finish();
+};
+
+#endif
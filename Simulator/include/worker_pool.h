@@ -0,0 +1,54 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+Threads of the multicore simulation that are started once and then wait for the next task, so a simulation
+performed in many small calls of advance does not start and join its threads on every call.
+*/
+class WorkerPool
+{
+
+// ##################################################################### //
+// ############################# VARIABLES ############################# //
+// ##################################################################### //
+
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable task_ready, task_done;
+    // task of the current run, only set while run is executing
+    const std::function<void(int)> *task = nullptr;
+    unsigned long generation = 0;
+    // number of pool threads that did not finish the current task yet
+    int busy = 0;
+    bool shutdown = false;
+
+// ##################################################################### //
+// ###################### CONSTRUCTOR & DESTRUCTOR ##################### //
+// ##################################################################### //
+
+public:
+    explicit WorkerPool(int thread_count);
+    ~WorkerPool();
+
+// ##################################################################### //
+// ############################## METHODS ############################## //
+// ##################################################################### //
+
+public:
+    // Number of threads a task runs on, including the calling thread
+    int size() const { return threads.size() + 1; }
+    // Runs the task once on every thread with the index of the thread and returns when all of them finished
+    void run(const std::function<void(int)> &task);
+
+private:
+    void work(int thread_index);
+};
+
+#endif
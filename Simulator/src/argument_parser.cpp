@@ -0,0 +1,175 @@
+#include "../include/argument_parser.h"
+#include <stdexcept>
+
+/// @brief Parses the positional arguments of a simulation with periodic boundary conditions and checks their validity
+/// @param arguments The arguments without the program name
+/// @param parameters The parameters to fill
+/// @return An empty string on success, otherwise the error message
+std::string parse_periodic_arguments(const std::vector<std::string> &arguments, PeriodicParameters &parameters)
+{
+    if (arguments.size() != PERIODIC_ARGUMENT_COUNT)
+        return "Error: Expected " + std::to_string(PERIODIC_ARGUMENT_COUNT) + " arguments but got " + std::to_string(arguments.size());
+
+    // parse the arguments
+    try
+    {
+        parameters.street_length = std::stoi(arguments[0]);
+        parameters.initial_cars = std::stoi(arguments[1]);
+        parameters.vmax = std::stoi(arguments[2]);
+        parameters.iterations = std::stoi(arguments[3]);
+        parameters.dawdle_probability = std::stof(arguments[4]);
+        parameters.always_unlimited = (arguments[5] == "true");
+        parameters.start_velocity_zero = (arguments[6] == "true");
+        parameters.multicore = (arguments[7] == "true");
+    }
+    catch (const std::invalid_argument &e)
+    {
+        return std::string("Invalid argument: ") + e.what();
+    }
+    catch (const std::out_of_range &e)
+    {
+        return std::string("Argument out of range: ") + e.what();
+    }
+
+    return validate_periodic_parameters(parameters);
+}
+
+/// @brief Checks the validity of the parameters of a simulation with periodic boundary conditions
+/// @param parameters The parameters to check
+/// @return An empty string on success, otherwise the error message
+std::string validate_periodic_parameters(const PeriodicParameters &parameters)
+{
+    if (parameters.street_length <= 0)
+        return "Error: Street length must be greater than 0";
+    if (parameters.initial_cars < 0)
+        return "Error: Number of initial cars must be greater than or equal to 0";
+    if (parameters.vmax != -1 && parameters.vmax < 0)
+        return "Error: Maximum speed must be greater than 0 or equal to -1 (to mark unlimited speed limit)";
+    if (parameters.initial_cars > parameters.street_length)
+        return "Error: Number of initial cars must be less than or equal to the street length";
+    if (parameters.iterations <= 0)
+        return "Error: Number of iterations must be greater than 0";
+    if (parameters.dawdle_probability < 0 || parameters.dawdle_probability > 1)
+        return "Error: Dawdle probability must be between 0 and 1";
+
+    return "";
+}
+
+/// @brief Parses the optional arguments and checks their validity
+/// @param options The options of the form --name=value
+/// @param parameters The parameters to fill, the street length has to be parsed already
+/// @return An empty string on success, otherwise the error message
+std::string parse_options(const std::vector<std::string> &options, PeriodicParameters &parameters)
+{
+    OutputOptions &output = parameters.output;
+    for (const std::string &option : options)
+    {
+        size_t separator = option.find('=');
+        std::string name = option.substr(0, separator);
+        std::string value = separator == std::string::npos ? "" : option.substr(separator + 1);
+        try
+        {
+            if (name == "--time-stride")
+                output.time_stride = std::stoi(value);
+            else if (name == "--space-stride")
+                output.space_stride = std::stoi(value);
+            else if (name == "--window")
+            {
+                size_t colon = value.find(':');
+                if (colon == std::string::npos)
+                    return "Error: Window must be given as <start>:<end>";
+                output.window_start = std::stoi(value.substr(0, colon));
+                output.window_end = std::stoi(value.substr(colon + 1));
+            }
+            else if (name == "--aggregate")
+            {
+                if (value == "min")
+                    output.aggregation = Aggregation::MIN;
+                else if (value == "mean")
+                    output.aggregation = Aggregation::MEAN;
+                else if (value == "max")
+                    output.aggregation = Aggregation::MAX;
+                else
+                    return "Error: Aggregation must be min, mean or max";
+            }
+            else if (name == "--image" && !value.empty())
+                output.image_file_name = value;
+            else if (name == "--no-csv")
+                output.csv = false;
+            else if (name == "--engine")
+            {
+                if (value == "cells")
+                    parameters.engine = Engine::CELLS;
+                else if (value == "car_list")
+                    parameters.engine = Engine::CAR_LIST;
+                else if (value == "auto")
+                    parameters.engine = Engine::AUTO;
+                else
+                    return "Error: Engine must be cells, car_list or auto";
+                parameters.engine_report = value;
+            }
+            else if (name == "--jams")
+            {
+                parameters.jams.enabled = true;
+                parameters.jams.file_name = value;
+            }
+            else if (name == "--jam-speed")
+                parameters.jams.max_speed = std::stoi(value);
+            else if (name == "--jam-gap")
+                parameters.jams.max_gap = std::stoi(value);
+            else if (name == "--jam-cars")
+                parameters.jams.min_cars = std::stoi(value);
+            else if (name == "--seed")
+                parameters.seed = std::stoll(value);
+            else if (name == "--keyframes")
+                parameters.keyframes.interval = std::stoi(value);
+            else if (name == "--keyframe-file" && !value.empty())
+                parameters.keyframes.file_name = value;
+            else if (name == "--threads")
+                parameters.threads = std::stoi(value);
+            else if (name == "--fleet")
+            {
+                try
+                {
+                    parameters.vehicle_classes = Fleet::load(value);
+                }
+                catch (const std::runtime_error &e)
+                {
+                    return e.what();
+                }
+            }
+            else
+                return "Error: Unknown option " + option;
+        }
+        catch (const std::invalid_argument &e)
+        {
+            return "Invalid argument: " + option;
+        }
+        catch (const std::out_of_range &e)
+        {
+            return "Argument out of range: " + option;
+        }
+    }
+
+    // check validity of the options
+    if (output.time_stride <= 0)
+        return "Error: Time stride must be greater than 0";
+    if (output.space_stride <= 0)
+        return "Error: Space stride must be greater than 0";
+    if (parameters.jams.max_speed < 0 || parameters.jams.max_gap < 0 || parameters.jams.min_cars < 1)
+        return "Error: Jam speed and gap must be greater than or equal to 0, jam cars greater than 0";
+    if (parameters.seed < -1 || parameters.seed > 4294967295LL)
+        return "Error: Seed must be between 0 and 4294967295";
+    if (parameters.keyframes.interval < 0)
+        return "Error: Keyframe interval must be greater than or equal to 0";
+    // the autotuner only considers single threaded engines when keyframes are recorded
+    if (parameters.keyframes.interval > 0 && parameters.multicore && parameters.engine == Engine::CELLS)
+        return "Error: Keyframes can only be recorded without multicore (they store the state of a single random number generator)";
+    if (parameters.threads < 0)
+        return "Error: Number of threads must be greater than or equal to 0 (0 to use all cores)";
+    int window_end = output.window_end == -1 ? parameters.street_length : output.window_end;
+    if (output.window_start < 0 || window_end > parameters.street_length || output.window_start >= window_end)
+        return "Error: Window must satisfy 0 <= start < end <= street_length";
+
+    return "";
+}
@@ -0,0 +1,224 @@
+#include "../include/autotuner.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <thread>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+// number of repetitions per candidate, the fastest repetition counts
+#define CALIBRATION_REPEATS 2
+
+// ##################################################################### //
+// ############################ CONSTRUCTORS ########################### //
+// ##################################################################### //
+
+Autotuner::Autotuner(const std::filesystem::path &cache_file_name) : cache_file_name(cache_file_name) {}
+
+// ##################################################################### //
+// ############################## METHODS ############################## //
+// ##################################################################### //
+
+/// @brief Method to replace Engine::AUTO by the fastest engine for the parameters
+/// @param parameters The parameters of the simulation, engine, multicore, threads and engine_report are set
+void Autotuner::tune(PeriodicParameters &parameters)
+{
+    if (parameters.engine != Engine::AUTO)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string key = bucket(parameters);
+    EngineChoice best{Engine::CELLS, 1};
+    std::string report;
+
+    if (load(key, best, report))
+    {
+        report = "auto -> " + describe(best) + " (cached: " + report + ")";
+    }
+    else
+    {
+        // measure all candidates and keep the fastest one
+        double best_time = std::numeric_limits<double>::max();
+        std::ostringstream measurements;
+        measurements << std::setprecision(3);
+        for (const EngineChoice &candidate : candidates(parameters))
+        {
+            double time = measure(parameters, candidate);
+            if (measurements.tellp() > 0)
+                measurements << "; ";
+            measurements << describe(candidate) << ": " << time << " ms/step";
+            if (time < best_time)
+            {
+                best_time = time;
+                best = candidate;
+            }
+        }
+        report = measurements.str();
+        store(key, best, report);
+        report = "auto -> " + describe(best) + " (" + report + ")";
+    }
+
+    parameters.engine = best.engine;
+    parameters.threads = best.threads;
+    parameters.multicore = best.engine == Engine::CELLS && best.threads > 1;
+    parameters.engine_report = report;
+}
+
+/// @brief Method to get the cache file next to the executable
+/// @return The path of the cache file
+std::filesystem::path Autotuner::default_cache_file()
+{
+    return SimulatorPeriodic::output_directory().parent_path() / "autotune.cache";
+}
+
+/// @brief Method to describe an engine choice, e.g. "cells x4"
+/// @param choice The engine and number of threads
+/// @return The description without spaces in the engine name
+std::string Autotuner::describe(const EngineChoice &choice)
+{
+    if (choice.engine == Engine::CAR_LIST)
+        return "car_list";
+    return "cells x" + std::to_string(choice.threads);
+}
+
+/// @brief Method to list the engines and thread counts worth measuring
+/// @param parameters The parameters of the simulation
+/// @return The candidates
+std::vector<EngineChoice> Autotuner::candidates(const PeriodicParameters &parameters)
+{
+    std::vector<EngineChoice> result = {{Engine::CAR_LIST, 1}, {Engine::CELLS, 1}};
+
+    // keyframes store the state of a single random number generator, so only the single threaded engines can record them
+    if (parameters.keyframes.interval > 0)
+        return result;
+
+    // powers of two up to the number of cores (and the number of cores itself), every thread needs at least one cell
+    int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    int max_threads = std::min(cores, parameters.street_length);
+    for (int threads = 2; threads < max_threads; threads *= 2)
+        result.push_back({Engine::CELLS, threads});
+    if (max_threads > 1)
+        result.push_back({Engine::CELLS, max_threads});
+    return result;
+}
+
+/// @brief Method to measure the time per step of a candidate with a short run without output
+/// @param parameters The parameters of the simulation
+/// @param choice The candidate to measure
+/// @return The fastest time per step of all repetitions in milliseconds
+double Autotuner::measure(const PeriodicParameters &parameters, const EngineChoice &choice)
+{
+    PeriodicParameters calibration = parameters;
+    // enough steps for about a few million cell updates, but at least a few steps
+    calibration.iterations = std::clamp(2000000 / std::max(1, parameters.street_length), 4, 200);
+    calibration.output = OutputOptions();
+    calibration.output.csv = false;
+    calibration.jams = JamOptions();
+    calibration.keyframes = KeyframeOptions();
+    calibration.engine = choice.engine;
+    calibration.threads = choice.threads;
+    calibration.multicore = choice.engine == Engine::CELLS && choice.threads > 1;
+    calibration.engine_report.clear();
+
+    double best = std::numeric_limits<double>::max();
+    for (int repeat = 0; repeat < CALIBRATION_REPEATS; repeat++)
+    {
+        // the time is taken from the end of the first step on, so the setup of the street and threads is not measured
+        std::chrono::steady_clock::time_point first, last;
+        SimulatorPeriodic simulator(calibration);
+        simulator.set_progress_callback([&](int finished_iterations)
+                                        {
+            if (finished_iterations == 1)
+                first = std::chrono::steady_clock::now();
+            last = std::chrono::steady_clock::now();
+            return true; });
+        simulator.perform_simulation();
+
+        double time = std::chrono::duration<double, std::milli>(last - first).count() / (calibration.iterations - 1);
+        best = std::min(best, time);
+    }
+    return best;
+}
+
+/// @brief Method to compute the cache key of the machine and the parameter bucket
+/// @param parameters The parameters of the simulation
+/// @return The key without whitespace
+std::string Autotuner::bucket(const PeriodicParameters &parameters)
+{
+    char host[256] = "unknown";
+#ifdef _WIN32
+    DWORD size = sizeof(host);
+    GetComputerNameA(host, &size);
+#else
+    gethostname(host, sizeof(host) - 1);
+#endif
+    std::string machine(host);
+    std::replace_if(machine.begin(), machine.end(), [](char c)
+                    { return std::isspace(static_cast<unsigned char>(c)); }, '_');
+
+    // street length in powers of two and density in steps of 5%
+    int length_bucket = static_cast<int>(std::log2(parameters.street_length));
+    int density_bucket = static_cast<long long>(parameters.initial_cars) * 20 / parameters.street_length;
+    std::string speed = parameters.always_unlimited ? "unlimited" : (parameters.vmax == -1 ? "distribution" : "vmax" + std::to_string(parameters.vmax));
+    // long vehicles change the cost of the engines, so every fleet is a bucket of its own
+    if (!parameters.vehicle_classes.empty())
+    {
+        speed = "fleet";
+        for (const VehicleClass &vehicle_class : parameters.vehicle_classes)
+            speed += "_" + vehicle_class.name + std::to_string(vehicle_class.max_speed) + "x" + std::to_string(vehicle_class.length);
+    }
+
+    return machine + "/" + std::to_string(std::thread::hardware_concurrency()) + "cores/length2^" + std::to_string(length_bucket) +
+           "/density" + std::to_string(density_bucket * 5) + "%/" + speed;
+}
+
+/// @brief Method to look up a bucket in the cache file
+/// @param key The key of the bucket
+/// @param choice Is set to the cached engine choice
+/// @param report Is set to the measurements of the cached calibration
+/// @return true if the bucket was found
+bool Autotuner::load(const std::string &key, EngineChoice &choice, std::string &report)
+{
+    // every line has the form "<key>\t<engine>\t<threads>\t<measurements>", later lines win
+    std::ifstream file(cache_file_name);
+    bool found = false;
+    for (std::string line; std::getline(file, line);)
+    {
+        std::istringstream stream(line);
+        std::string line_key, engine, threads, measurements;
+        if (!std::getline(stream, line_key, '\t') || line_key != key || !std::getline(stream, engine, '\t') ||
+            !std::getline(stream, threads, '\t') || !std::getline(stream, measurements))
+            continue;
+        try
+        {
+            choice = {engine == "car_list" ? Engine::CAR_LIST : Engine::CELLS, std::max(1, std::stoi(threads))};
+        }
+        catch (const std::exception &)
+        {
+            continue;
+        }
+        report = measurements;
+        found = true;
+    }
+    return found;
+}
+
+/// @brief Method to append the result of a calibration to the cache file
+/// @param key The key of the bucket
+/// @param choice The fastest engine
+/// @param report The measurements of all candidates
+void Autotuner::store(const std::string &key, const EngineChoice &choice, const std::string &report)
+{
+    std::ofstream file(cache_file_name, std::ios::app);
+    // a cache that can not be written only costs another calibration next time
+    if (!file.is_open())
+        return;
+    file << key << "\t" << (choice.engine == Engine::CAR_LIST ? "car_list" : "cells") << "\t" << choice.threads << "\t" << report << "\n";
+}
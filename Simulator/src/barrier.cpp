@@ -0,0 +1,30 @@
+#include "../include/barrier.h"
+
+// ##################################################################### //
+// ############################ CONSTRUCTORS ########################### //
+// ##################################################################### //
+
+Barrier::Barrier(int thread_count) : thread_count(thread_count) {}
+
+// ##################################################################### //
+// ############################## METHODS ############################## //
+// ##################################################################### //
+
+/// @brief Blocks until all threads arrived at the barrier
+/// @param completion Function run by the last arriving thread while the other threads are still waiting
+void Barrier::arrive_and_wait(const std::function<void()> &completion)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    unsigned long arrival_generation = generation;
+    if (++waiting == thread_count)
+    {
+        if (completion)
+            completion();
+        waiting = 0;
+        generation++;
+        released.notify_all();
+        return;
+    }
+    released.wait(lock, [this, arrival_generation]
+                  { return generation != arrival_generation; });
+}
@@ -0,0 +1,143 @@
+#include "../include/fleet.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+// ##################################################################### //
+// ############################ CONSTRUCTORS ########################### //
+// ##################################################################### //
+
+/// @brief Constructor to build the table of the kernels from the classes
+/// @param classes The classes of the fleet, at least one and at most MAX_VEHICLE_CLASSES
+Fleet::Fleet(const std::vector<VehicleClass> &classes)
+{
+    if (classes.empty() || classes.size() > MAX_VEHICLE_CLASSES)
+        throw std::runtime_error("Error: A fleet needs between 1 and " + std::to_string(MAX_VEHICLE_CLASSES) + " vehicle classes (Code: 163)");
+
+    double total_share = 0;
+    for (const VehicleClass &vehicle_class : classes)
+    {
+        std::string error = validate(vehicle_class);
+        if (!error.empty())
+            throw std::runtime_error(error + " (Code: 162)");
+        table.push_back({vehicle_class.max_speed, vehicle_class.acceleration, vehicle_class.length, vehicle_class.dawdle_probability});
+        total_share += vehicle_class.share;
+        cumulative_shares.push_back(total_share);
+        max_speed = std::max(max_speed, vehicle_class.max_speed);
+        max_length = std::max(max_length, vehicle_class.length);
+    }
+    for (double &share : cumulative_shares)
+        share /= total_share;
+}
+
+// ##################################################################### //
+// ############################## METHODS ############################## //
+// ##################################################################### //
+
+/// @brief Method to draw the class of a new vehicle, a fleet with a single class does not use the generator
+/// @param rng Random number generator
+/// @return The index of the class
+unsigned char Fleet::draw(CountingRng &rng) const
+{
+    if (table.size() == 1)
+        return 0;
+    // Generate a distribution from 0 to 1 to get a random number from
+    std::uniform_real_distribution<> dis(0, 1);
+    double random_number = dis(rng);
+    for (size_t k = 0; k + 1 < cumulative_shares.size(); k++)
+    {
+        if (random_number <= cumulative_shares[k])
+            return k;
+    }
+    // the last share is 1 up to rounding errors
+    return cumulative_shares.size() - 1;
+}
+
+/// @brief Method to read the vehicle classes from a fleet file
+/// @param file_name Name of the file, every line has the form "<name> <share> <max_speed> <dawdle_probability|-> <acceleration> <length>",
+/// everything after a # is a comment
+/// @return The classes in the order of the file
+std::vector<VehicleClass> Fleet::load(const std::string &file_name)
+{
+    std::ifstream file(file_name);
+    if (!file.is_open())
+        throw std::runtime_error("Error: Could not open fleet file " + file_name + " (Code: 160)");
+
+    std::vector<VehicleClass> classes;
+    int line_number = 0;
+    for (std::string line; std::getline(file, line);)
+    {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream stream(line);
+        std::string name, dawdle_probability, rest;
+        if (!(stream >> name))
+            continue;
+
+        VehicleClass vehicle_class;
+        vehicle_class.name = name;
+        stream >> vehicle_class.share >> vehicle_class.max_speed >> dawdle_probability >> vehicle_class.acceleration >> vehicle_class.length;
+        if (!stream || stream >> rest)
+            throw std::runtime_error("Error: Line " + std::to_string(line_number) + " of fleet file " + file_name + " does not have the form <name> <share> <max_speed> <dawdle_probability|-> <acceleration> <length> (Code: 161)");
+        try
+        {
+            vehicle_class.dawdle_probability = dawdle_probability == "-" ? -1 : std::stof(dawdle_probability);
+        }
+        catch (const std::exception &)
+        {
+            throw std::runtime_error("Error: Invalid dawdle probability " + dawdle_probability + " in line " + std::to_string(line_number) + " of fleet file " + file_name + " (Code: 161)");
+        }
+
+        std::string error = validate(vehicle_class);
+        if (!error.empty())
+            throw std::runtime_error(error + " in line " + std::to_string(line_number) + " of fleet file " + file_name + " (Code: 162)");
+        classes.push_back(vehicle_class);
+    }
+
+    if (classes.empty() || classes.size() > MAX_VEHICLE_CLASSES)
+        throw std::runtime_error("Error: Fleet file " + file_name + " needs between 1 and " + std::to_string(MAX_VEHICLE_CLASSES) + " vehicle classes (Code: 163)");
+    return classes;
+}
+
+/// @brief Method to get the classes of the fleet described by the positional arguments
+/// @param always_unlimited if true, all cars have the max speed 10
+/// @param vmax The max speed of all cars, -1 to use the speed distribution on unlimited speed sections
+/// @return The classes, all of them use the dawdle probability of the simulation
+std::vector<VehicleClass> Fleet::default_classes(bool always_unlimited, int vmax)
+{
+    if (always_unlimited)
+        return {{"unlimited", 1.00, 10, -1, 1, 1}};
+    if (vmax != -1)
+        return {{"car", 1.00, vmax, -1, 1, 1}};
+
+    /* Speed distribution on the german highways for unlimited speed sections (Data from https://www.iwkoeln.de/studien/thomas-puls-jan-marten-wendt-schneller-als-130-regel-oder-ausnahme.html, 18.01.2025)
+    By simplifying the data, we can say that 77% of the cars drive 130 km/h at max, 18% 160 km/h at max and 5% even faster */
+    return {
+        {"unlimited", 0.05, 10, -1, 1, 1}, // faster than 270 km/h is rare and therefore not considered for the sake of simplicity
+        {"160kmh", 0.18, 6, -1, 1, 1},
+        {"130kmh", 0.77, 5, -1, 1, 1}};
+}
+
+/// @brief Method to check the values of a vehicle class
+/// @param vehicle_class The class to check
+/// @return An empty string if the class is valid, otherwise the error message
+std::string Fleet::validate(const VehicleClass &vehicle_class)
+{
+    const std::string prefix = "Error: Vehicle class " + vehicle_class.name + ": ";
+    if (vehicle_class.name.empty() || std::any_of(vehicle_class.name.begin(), vehicle_class.name.end(), [](char c)
+                                                  { return std::isspace(static_cast<unsigned char>(c)); }))
+        return "Error: The name of a vehicle class must not be empty or contain whitespace";
+    if (!(vehicle_class.share > 0))
+        return prefix + "Share must be greater than 0";
+    if (vehicle_class.max_speed < 0)
+        return prefix + "Maximum speed must be greater than or equal to 0";
+    if (vehicle_class.dawdle_probability != -1 && (vehicle_class.dawdle_probability < 0 || vehicle_class.dawdle_probability > 1))
+        return prefix + "Dawdle probability must be between 0 and 1 (or - to use the dawdle probability of the simulation)";
+    if (vehicle_class.acceleration < 1)
+        return prefix + "Acceleration must be greater than 0";
+    if (vehicle_class.length < 1)
+        return prefix + "Length must be greater than 0";
+    return "";
+}
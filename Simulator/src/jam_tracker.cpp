@@ -0,0 +1,253 @@
+#include "../include/jam_tracker.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// width of the bins of the propagation speed histogram in cells per step
+#define SPEED_BIN_WIDTH 0.1f
+
+// #################################################################### //
+// ##################### CONSTRUCTOR & DESTRUCTOR ##################### //
+// #################################################################### //
+
+/// @brief Constructor to open the jam file and write the header of the events
+/// @param options When cars count as a jam and the file name
+/// @param street_length Length of the street
+JamTracker::JamTracker(const JamOptions &options, int street_length) : options(options), street_length(street_length), owner(street_length, -1)
+{
+    file.open(options.file_name, std::ios::trunc);
+    if (!file.is_open())
+        throw std::runtime_error("Error: Could not open jam file " + options.file_name + " (Code: 130)");
+    file << "event,step,jam,tail,head,cars,lifetime,speed,reason\n";
+}
+
+// ##################################################################### //
+// ############################## METHODS ############################## //
+// ##################################################################### //
+
+/// @brief Method to find the jams after a step and link them to the jams of the previous step
+/// @param step The number of the step
+/// @param positions The positions of the cars in ascending order
+/// @param speeds The speeds of the cars in the same order
+/// @param lengths The lengths of the cars in the same order
+void JamTracker::observe(int step, const std::vector<int> &positions, const std::vector<int> &speeds, const std::vector<int> &lengths)
+{
+    find_clusters(positions, speeds, lengths);
+
+    // every old jam is continued by the new cluster with the most cars among the clusters overlapping it,
+    // clusters are allowed to be up to max_gap + 1 cells away since the jams move
+    int margin = options.max_gap + 1;
+    winner.assign(jams.size(), -1);
+    overlapping.assign(clusters.size(), false);
+    for (size_t c = 0; c < clusters.size(); c++)
+    {
+        int cells = std::min(street_length, (clusters[c].head - clusters[c].tail + street_length) % street_length + 1 + 2 * margin);
+        int start = ((clusters[c].tail - margin) % street_length + street_length) % street_length;
+        for (int offset = 0; offset < cells; offset++)
+        {
+            int jam = owner[(start + offset) % street_length];
+            if (jam == -1)
+                continue;
+            overlapping[c] = true;
+            if (winner[jam] == -1 || clusters[c].cars > clusters[winner[jam]].cars)
+                winner[jam] = c;
+        }
+    }
+
+    // a cluster continuing several jams keeps the oldest one, the others are merged into it
+    inherited.assign(clusters.size(), -1);
+    for (size_t jam = 0; jam < jams.size(); jam++)
+    {
+        int c = winner[jam];
+        if (c == -1)
+        {
+            close_jam(step, jams[jam], "dissolved");
+            continue;
+        }
+        int kept = inherited[c];
+        if (kept == -1)
+        {
+            inherited[c] = jam;
+            continue;
+        }
+        // keep the older jam, the younger one is merged into it
+        if (jams[jam].birth < jams[kept].birth)
+        {
+            inherited[c] = jam;
+            close_jam(step, jams[kept], "merged");
+        }
+        else
+            close_jam(step, jams[jam], "merged");
+    }
+
+    // remove the old jams from the cells
+    for (const Jam &jam : jams)
+        mark(jam, -1);
+
+    // build the jams of this step
+    next_jams.clear();
+    for (size_t c = 0; c < clusters.size(); c++)
+    {
+        const Cluster &cluster = clusters[c];
+        if (inherited[c] == -1)
+        {
+            // a cluster that overlaps a jam without continuing it was split off
+            Jam jam{next_id++, step, cluster.tail, cluster.head, cluster.cars, cluster.cars, 0};
+            write_event("birth", step, jam, overlapping[c] ? "split" : "new");
+            next_jams.push_back(jam);
+            continue;
+        }
+        Jam jam = jams[inherited[c]];
+        // the head moves less than half the street per step, so the shortest distance is the movement
+        int delta = cluster.head - jam.head;
+        if (delta > street_length / 2)
+            delta -= street_length;
+        else if (delta < -street_length / 2)
+            delta += street_length;
+        jam.displacement += delta;
+        jam.tail = cluster.tail;
+        jam.head = cluster.head;
+        jam.cars = cluster.cars;
+        jam.max_cars = std::max(jam.max_cars, cluster.cars);
+        next_jams.push_back(jam);
+    }
+    std::swap(jams, next_jams);
+    for (size_t jam = 0; jam < jams.size(); jam++)
+        mark(jams[jam], jam);
+
+    steps++;
+    alive_sum += jams.size();
+    max_alive = std::max(max_alive, static_cast<int>(jams.size()));
+    last_step = step;
+}
+
+/// @brief Method to close the jams that are still open and write the summary and the histograms
+void JamTracker::finish()
+{
+    if (!file.is_open())
+        return;
+    for (const Jam &jam : jams)
+        close_jam(last_step, jam, "end");
+    jams.clear();
+
+    file << "\nsteps,jams,mean_alive,max_alive,open_at_end\n"
+         << steps << "," << next_id << "," << (steps ? static_cast<double>(alive_sum) / steps : 0.0) << "," << max_alive << "," << open_at_end << "\n";
+
+    file << "\nquantity,bin_start,bin_end,count\n";
+    write_histogram("length", length_histogram, true, 1);
+    write_histogram("lifetime", lifetime_histogram, true, 1);
+    write_histogram("speed", speed_histogram, false, SPEED_BIN_WIDTH);
+    file.close();
+}
+
+/// @brief Method to group the slow cars into clusters of at least min_cars cars
+/// @param positions The positions of the cars in ascending order
+/// @param speeds The speeds of the cars in the same order
+/// @param lengths The lengths of the cars in the same order, the position of a car is the cell of its front
+void JamTracker::find_clusters(const std::vector<int> &positions, const std::vector<int> &speeds, const std::vector<int> &lengths)
+{
+    clusters.clear();
+    int car_count = positions.size();
+
+    // two neighbouring cars belong to the same jam if both are slow and close enough, the gap ends at the rear of the next car
+    auto connected = [&](int k, int next)
+    {
+        int gap = ((positions[next] - lengths[next] - positions[k]) % street_length + street_length) % street_length;
+        return speeds[k] <= options.max_speed && speeds[next] <= options.max_speed && gap <= options.max_gap;
+    };
+
+    bool first_starts_at_zero = false;
+    for (int k = 0; k < car_count; k++)
+    {
+        if (speeds[k] > options.max_speed)
+            continue;
+        if (k > 0 && !clusters.empty() && connected(k - 1, k))
+        {
+            clusters.back().head = positions[k];
+            clusters.back().cars++;
+            continue;
+        }
+        if (k == 0)
+            first_starts_at_zero = true;
+        clusters.push_back({positions[k], positions[k], 1});
+    }
+
+    // the jam at the end of the street can continue at its beginning
+    if (clusters.size() > 1 && first_starts_at_zero && clusters.back().head == positions[car_count - 1] && connected(car_count - 1, 0))
+    {
+        clusters.front().tail = clusters.back().tail;
+        clusters.front().cars += clusters.back().cars;
+        clusters.pop_back();
+    }
+
+    // drop the clusters that are too small to count as a jam
+    clusters.erase(std::remove_if(clusters.begin(), clusters.end(), [this](const Cluster &cluster)
+                                  { return cluster.cars < options.min_cars; }),
+                   clusters.end());
+}
+
+/// @brief Method to mark the cells of a jam
+/// @param jam The jam
+/// @param index The index to write to the cells, -1 to remove the jam
+void JamTracker::mark(const Jam &jam, int index)
+{
+    int cells = (jam.head - jam.tail + street_length) % street_length + 1;
+    for (int offset = 0; offset < cells; offset++)
+        owner[(jam.tail + offset) % street_length] = index;
+}
+
+/// @brief Method to write a birth or death event
+void JamTracker::write_event(const char *event, int step, const Jam &jam, const char *reason)
+{
+    file << event << "," << step << "," << jam.id << "," << jam.tail << "," << jam.head << ",";
+    if (event[0] == 'b')
+    {
+        file << jam.cars << ",,," << reason << "\n";
+        return;
+    }
+    int lifetime = step - jam.birth;
+    file << jam.max_cars << "," << lifetime << "," << (lifetime ? static_cast<double>(jam.displacement) / lifetime : 0.0) << "," << reason << "\n";
+}
+
+/// @brief Method to write the death of a jam and add it to the histograms
+/// @param step The step the jam ended at
+/// @param jam The jam
+/// @param reason Why the jam ended, jams that are still open at the end are not counted in the lifetime and speed histograms
+void JamTracker::close_jam(int step, const Jam &jam, const char *reason)
+{
+    write_event("death", step, jam, reason);
+    length_histogram[jam.max_cars]++;
+    int lifetime = step - jam.birth;
+    if (reason[0] == 'e')
+    {
+        open_at_end++;
+        return;
+    }
+    lifetime_histogram[lifetime]++;
+    speed_histogram[static_cast<int>(std::floor(jam.displacement / (lifetime * SPEED_BIN_WIDTH)))]++;
+}
+
+/// @brief Method to write a histogram
+/// @param quantity The name of the quantity
+/// @param histogram The counts per value (or per bin index for linear bins)
+/// @param logarithmic If true the values are grouped into bins [2^k, 2^(k+1)-1]
+/// @param bin_width The width of the linear bins
+void JamTracker::write_histogram(const char *quantity, const std::map<int, int> &histogram, bool logarithmic, float bin_width)
+{
+    if (!logarithmic)
+    {
+        for (const auto &[bin, count] : histogram)
+            file << quantity << "," << bin * bin_width << "," << (bin + 1) * bin_width << "," << count << "\n";
+        return;
+    }
+    std::map<int, int> bins;
+    for (const auto &[value, count] : histogram)
+    {
+        int bin_start = 1;
+        while (bin_start * 2 <= value)
+            bin_start *= 2;
+        bins[bin_start] += count;
+    }
+    for (const auto &[bin_start, count] : bins)
+        file << quantity << "," << bin_start << "," << bin_start * 2 - 1 << "," << count << "\n";
+}
@@ -0,0 +1,175 @@
+#include "../include/keyframe_store.h"
+#include "../include/simulator_periodic.h"
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+// first word of the parameter line, followed by the version of the layout
+#define KEYFRAME_MAGIC "NASCH-KEYFRAMES"
+#define KEYFRAME_VERSION 4
+
+// ##################################################################### //
+// ############################ CONSTRUCTORS ########################### //
+// ##################################################################### //
+
+/// @brief Constructor to create a new keyframe file and write the parameters
+/// @param file_name Name of the file, an existing file is overwritten
+/// @param parameters The parameters of the simulation
+/// @param seed The seed the random number generator was seeded with
+/// @param interval Number of steps between two keyframes
+KeyframeStore::KeyframeStore(const std::string &file_name, const PeriodicParameters &parameters, unsigned int seed, int interval)
+    : car_count(parameters.initial_cars), interval(interval), seed(seed)
+{
+    if (interval <= 0)
+        throw std::runtime_error("Error: Keyframe interval must be greater than 0 (Code: 140)");
+    file.open(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        throw std::runtime_error("Error: Could not open keyframe file " + file_name + " (Code: 141)");
+
+    // the probabilities and shares are written with all their digits, the replay has to use exactly the same values
+    std::ostringstream line;
+    line << std::setprecision(std::numeric_limits<double>::max_digits10);
+    line << KEYFRAME_MAGIC << " " << KEYFRAME_VERSION << " " << parameters.street_length << " " << parameters.initial_cars << " "
+         << parameters.vmax << " " << parameters.iterations << " " << parameters.dawdle_probability << " "
+         << parameters.always_unlimited << " " << parameters.start_velocity_zero << " " << interval << " " << seed;
+    // the classes of a fleet file are stored as well, so the keyframes can be replayed without the file
+    line << " " << parameters.vehicle_classes.size();
+    for (const VehicleClass &vehicle_class : parameters.vehicle_classes)
+        line << " " << vehicle_class.name << " " << vehicle_class.share << " " << vehicle_class.max_speed << " " << vehicle_class.dawdle_probability
+             << " " << vehicle_class.acceleration << " " << vehicle_class.length;
+    parameter_line = line.str();
+    file << parameter_line << "\n";
+    header_size = file.tellp();
+}
+
+/// @brief Constructor to open an existing keyframe file for reading
+/// @param file_name Name of the file
+KeyframeStore::KeyframeStore(const std::string &file_name)
+{
+    file.open(file_name, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        throw std::runtime_error("Error: Could not open keyframe file " + file_name + " (Code: 141)");
+
+    std::getline(file, parameter_line);
+    header_size = file.tellg();
+    std::istringstream line(parameter_line);
+    std::string magic;
+    int version, street_length, vmax, iterations, always_unlimited, start_velocity_zero;
+    float dawdle_probability;
+    line >> magic >> version >> street_length >> car_count >> vmax >> iterations >> dawdle_probability >> always_unlimited >> start_velocity_zero >> interval >> seed;
+    if (!line || magic != KEYFRAME_MAGIC || version != KEYFRAME_VERSION)
+        throw std::runtime_error("Error: " + file_name + " is not a keyframe file (Code: 142)");
+}
+
+// ##################################################################### //
+// ############################## METHODS ############################## //
+// ##################################################################### //
+
+/// @brief Method to append a keyframe
+/// @param keyframe The state after a step
+void KeyframeStore::write(const Keyframe &keyframe)
+{
+    if (static_cast<int>(keyframe.positions.size()) != car_count)
+        throw std::runtime_error("Error: Keyframe has " + std::to_string(keyframe.positions.size()) + " cars instead of " + std::to_string(car_count) + " (Code: 144)");
+
+    int32_t step = keyframe.step;
+    file.write(reinterpret_cast<const char *>(&step), sizeof(step));
+    uint64_t rng_count = keyframe.rng_count;
+    file.write(reinterpret_cast<const char *>(&rng_count), sizeof(rng_count));
+    for (int k = 0; k < car_count; k++)
+    {
+        int32_t position = keyframe.positions[k];
+        int32_t speed = keyframe.speeds[k];
+        uint8_t vehicle_class = keyframe.vehicle_classes[k];
+        file.write(reinterpret_cast<const char *>(&position), sizeof(position));
+        file.write(reinterpret_cast<const char *>(&speed), sizeof(speed));
+        file.write(reinterpret_cast<const char *>(&vehicle_class), sizeof(vehicle_class));
+    }
+    if (!file)
+        throw std::runtime_error("Error: Could not write keyframe (Code: 145)");
+}
+
+/// @brief Method to read the last keyframe at or before the given step
+/// @param step The step that should be restored
+/// @return The keyframe
+Keyframe KeyframeStore::read_nearest(int step)
+{
+    int available = count();
+    if (available == 0)
+        throw std::runtime_error("Error: Keyframe file contains no keyframes (Code: 146)");
+    int index = std::min(step / interval, available - 1);
+
+    file.clear();
+    file.seekg(header_size + index * record_size());
+    Keyframe keyframe;
+    int32_t keyframe_step;
+    file.read(reinterpret_cast<char *>(&keyframe_step), sizeof(keyframe_step));
+    keyframe.step = keyframe_step;
+
+    uint64_t rng_count;
+    file.read(reinterpret_cast<char *>(&rng_count), sizeof(rng_count));
+    keyframe.rng_count = rng_count;
+
+    keyframe.positions.resize(car_count);
+    keyframe.speeds.resize(car_count);
+    keyframe.vehicle_classes.resize(car_count);
+    for (int k = 0; k < car_count; k++)
+    {
+        int32_t position, speed;
+        uint8_t vehicle_class;
+        file.read(reinterpret_cast<char *>(&position), sizeof(position));
+        file.read(reinterpret_cast<char *>(&speed), sizeof(speed));
+        file.read(reinterpret_cast<char *>(&vehicle_class), sizeof(vehicle_class));
+        keyframe.positions[k] = position;
+        keyframe.speeds[k] = speed;
+        keyframe.vehicle_classes[k] = vehicle_class;
+    }
+    if (!file)
+        throw std::runtime_error("Error: Could not read keyframe " + std::to_string(index) + " (Code: 147)");
+    return keyframe;
+}
+
+/// @brief Method to get the parameters of the recorded simulation
+/// @return The parameters without output settings and output file name
+PeriodicParameters KeyframeStore::parameters() const
+{
+    std::istringstream line(parameter_line);
+    std::string magic;
+    int version, unused_interval;
+    size_t class_count;
+    PeriodicParameters parameters;
+    line >> magic >> version >> parameters.street_length >> parameters.initial_cars >> parameters.vmax >> parameters.iterations >>
+        parameters.dawdle_probability >> parameters.always_unlimited >> parameters.start_velocity_zero >> unused_interval >> parameters.seed >> class_count;
+    for (size_t c = 0; line && c < class_count; c++)
+    {
+        VehicleClass vehicle_class;
+        line >> vehicle_class.name >> vehicle_class.share >> vehicle_class.max_speed >> vehicle_class.dawdle_probability >> vehicle_class.acceleration >> vehicle_class.length;
+        parameters.vehicle_classes.push_back(vehicle_class);
+    }
+    if (!line)
+        throw std::runtime_error("Error: Invalid parameters in keyframe file (Code: 142)");
+    parameters.multicore = false;
+    return parameters;
+}
+
+/// @brief Method to get the number of steps between two keyframes
+int KeyframeStore::get_interval() const
+{
+    return interval;
+}
+
+/// @brief Method to count the complete keyframes in the file
+int KeyframeStore::count()
+{
+    file.clear();
+    file.seekg(0, std::ios::end);
+    return static_cast<int>((static_cast<std::streamoff>(file.tellg()) - header_size) / record_size());
+}
+
+/// @brief Method to compute the size of one keyframe in bytes
+std::streamoff KeyframeStore::record_size() const
+{
+    return sizeof(int32_t) + sizeof(uint64_t) + static_cast<std::streamoff>(car_count) * (2 * sizeof(int32_t) + sizeof(uint8_t));
+}
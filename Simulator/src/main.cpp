@@ -1,84 +1,123 @@
 #include "simulator_periodic.h"
+#include "argument_parser.h"
+#include "simulation_server.h"
+#include "autotuner.h"
 #include <iostream>
 #include <chrono>
+#include <thread>
+#include <algorithm>
 
 int main(int argc, char *argv[])
 {
     // start the timer to measure the duration of the simulation
     auto start = std::chrono::high_resolution_clock::now();
 
-    // check if the user provided the correct number of arguments
-    if (argc == 9) // periodic boundary conditions
+    // start the simulation daemon which accepts jobs over a unix domain socket
+    if (argc >= 3 && argv[1] == std::string("--server"))
     {
-        // parse the command line arguments and check their validity
-        int street_length;
-        int initial_cars;
-        int vmax;
-        int iterations;
-        float dawdle_probability;
-        bool always_unlimited;
-        bool start_velocity_zero;
-        bool multicore;
-
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
         try
         {
-            street_length = std::stoi(argv[1]);
-            initial_cars = std::stoi(argv[2]);
-            vmax = std::stoi(argv[3]);
-            iterations = std::stoi(argv[4]);
-            dawdle_probability = std::stof(argv[5]);
-            always_unlimited = (argv[6] == std::string("true"));
-            start_velocity_zero = (argv[7] == std::string("true"));
-            multicore = (argv[8] == std::string("true"));
+            int threads = argc >= 4 ? std::stoi(argv[3]) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            SimulationServer server(argv[2], threads);
+            std::cout << "Listening on " << argv[2] << " with " << threads << " worker threads" << std::endl;
+            server.run();
         }
-        catch (const std::invalid_argument &e)
+        catch (const std::exception &e)
         {
-            std::cerr << "Invalid argument: " << e.what() << std::endl;
-            return 1;
-        }
-        catch (const std::out_of_range &e)
-        {
-            std::cerr << "Argument out of range: " << e.what() << std::endl;
+            std::cerr << "Server error: " << e.what() << std::endl;
             return 1;
         }
+        return 0;
+#else
+        std::cerr << "Error: The server mode is only available on unix systems" << std::endl;
+        return 1;
+#endif
+    }
 
-        // check validity of the parameters
-        if (street_length <= 0)
-        {
-            std::cerr << "Error: Street length must be greater than 0" << std::endl;
-            return 1;
-        }
-        if (initial_cars < 0)
-        {
-            std::cerr << "Error: Number of initial cars must be greater than or equal to 0" << std::endl;
-            return 1;
-        }
-        if (vmax != -1 && vmax < 0)
+    // restore steps of a recorded simulation from its keyframes, the frames are written to stdout or the given file
+    if (argc >= 5 && argv[1] == std::string("--replay"))
+    {
+        try
         {
-            std::cerr << "Error: Maximum speed must be greater than 0 or equal to -1 (to mark unlimited speed limit)" << std::endl;
-            return 1;
+            KeyframeStore store(argv[2]);
+            PeriodicParameters parameters = store.parameters();
+            int first_step = std::stoi(argv[3]);
+            int last_step = std::stoi(argv[4]);
+            if (first_step < 0 || first_step > last_step || last_step > parameters.iterations)
+            {
+                std::cerr << "Error: Steps must satisfy 0 <= first_step <= last_step <= " << parameters.iterations << std::endl;
+                return 1;
+            }
+
+            // the output file is an option of the replay, all other options have to be output options
+            std::vector<std::string> options;
+            for (int i = 5; i < argc; i++)
+            {
+                std::string option = argv[i];
+                if (option.rfind("--output=", 0) == 0)
+                    parameters.output_file_name = option.substr(9);
+                else
+                    options.push_back(option);
+            }
+            // the fleet and the seed are taken from the keyframe file, they can not be replaced by an option
+            std::vector<VehicleClass> recorded_classes = parameters.vehicle_classes;
+            long long recorded_seed = parameters.seed;
+            parameters.vehicle_classes.clear();
+            std::string error = parse_options(options, parameters);
+            if (error.empty() && (parameters.jams.enabled || parameters.keyframes.interval > 0 || parameters.engine != Engine::CELLS || !parameters.vehicle_classes.empty() || parameters.seed != recorded_seed))
+                error = "Error: Only output options can be used with --replay";
+            parameters.vehicle_classes = recorded_classes;
+            if (!error.empty())
+            {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+
+            // the header and the frames cover the replayed steps
+            parameters.iterations = last_step - first_step;
+            SimulatorPeriodic simulator(parameters);
+            if (parameters.output_file_name.empty())
+                simulator.set_output_stream(&std::cout);
+            simulator.perform_replay(store, first_step, last_step);
         }
-        if (initial_cars > street_length)
+        catch (const std::logic_error &e)
         {
-            std::cerr << "Error: Number of initial cars must be less than or equal to the street length" << std::endl;
+            std::cerr << "Invalid argument: " << e.what() << std::endl;
             return 1;
         }
-        if (iterations <= 0)
+        catch (const std::runtime_error &e)
         {
-            std::cerr << "Error: Number of iterations must be greater than 0" << std::endl;
+            std::cerr << "Runtime error: " << e.what() << std::endl;
             return 1;
         }
-        if (dawdle_probability < 0 || dawdle_probability > 1)
+        return 0;
+    }
+
+    // check if the user provided the correct number of arguments
+    if (argc >= PERIODIC_ARGUMENT_COUNT + 1) // periodic boundary conditions
+    {
+        // parse the command line arguments and the output options and check their validity
+        PeriodicParameters parameters;
+        std::string error = parse_periodic_arguments(std::vector<std::string>(argv + 1, argv + PERIODIC_ARGUMENT_COUNT + 1), parameters);
+        if (error.empty())
+            error = parse_options(std::vector<std::string>(argv + PERIODIC_ARGUMENT_COUNT + 1, argv + argc), parameters);
+        if (!error.empty())
         {
-            std::cerr << "Error: Dawdle probability must be between 0 and 1" << std::endl;
+            std::cerr << error << std::endl;
             return 1;
         }
 
         // create a new simulator object and perform the simulation
         try
         {
+            // let the autotuner choose the engine if requested
+            if (parameters.engine == Engine::AUTO)
+                Autotuner(Autotuner::default_cache_file()).tune(parameters);
+
             // Create a new simulator object
-            SimulatorPeriodic simulator(street_length, initial_cars, vmax, iterations, dawdle_probability, always_unlimited, start_velocity_zero, multicore);
+            parameters.output_file_name = SimulatorPeriodic::default_output_file_name();
+            SimulatorPeriodic simulator(parameters);
 
             // Perform the simulation
             simulator.perform_simulation();
@@ -183,10 +222,19 @@ int main(int argc, char *argv[])
     {
         std::cerr << "Usage for periodic boundary conditions: " << argv[0]
                   << " <street_length> <initial_cars> <vmax> <iterations> <dawdle_probability> <always_unlimited> <start_velocity_zero> <multicore>"
+                  << " [--time-stride=<n>] [--window=<start>:<end>] [--space-stride=<n>] [--aggregate=<min|mean|max>] [--image=<file.pgm|file.ppm>] [--no-csv] [--engine=<cells|car_list|auto>] [--threads=<n>]"
+                  << " [--jams[=<file>]] [--jam-speed=<n>] [--jam-gap=<n>] [--jam-cars=<n>]"
+                  << " [--seed=<n>] [--keyframes=<n>] [--keyframe-file=<file>] [--fleet=<file>]"
                   << std::endl;
         std::cerr << "Usage for open boundary conditions: " << argv[0]
                   << " <street_length> <initial_cars> <vmax> <iterations> <dawdle_probability> <remove_probability> <insert_probability> <remove_space> <always_unlimited> <start_velocity_zero> <multicore>"
                   << std::endl;
+        std::cerr << "Usage to replay steps from keyframes: " << argv[0]
+                  << " --replay <keyframe_file> <first_step> <last_step> [--output=<file>] [output options]"
+                  << std::endl;
+        std::cerr << "Usage for the simulation server: " << argv[0]
+                  << " --server <socket_path> [threads]"
+                  << std::endl;
         return 1;
     }
 
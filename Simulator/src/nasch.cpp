@@ -0,0 +1,262 @@
+#include "../include/nasch.h"
+#include "../include/simulator_periodic.h"
+#include "../include/argument_parser.h"
+#include "../include/autotuner.h"
+#include "../include/fleet.h"
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+// size a struct of the caller needs to contain a field
+#define NASCH_FIELD_END(type, field) (offsetof(type, field) + sizeof(type::field))
+
+// callers of version 1 read the max speeds with the stride of the cars
+static_assert(sizeof(Car) % sizeof(int) == 0, "The max speeds of version 1 need a stride of whole ints");
+
+// Simulation behind the handle of the C interface
+struct nasch_simulation
+{
+    SimulatorPeriodic simulator;
+    // max speeds of the cars, the cars themselves only store their class
+    std::vector<int> max_speeds;
+    // the same max speeds with the stride of the cars, only built for callers of version 1
+    mutable std::vector<int> strided_max_speeds;
+
+    explicit nasch_simulation(const PeriodicParameters &parameters) : simulator(parameters) {}
+};
+
+// message of the last error, every thread has its own
+static thread_local std::string last_error;
+
+/// @brief Runs a function and converts an exception into the error of the calling thread
+/// @param function The function to run
+/// @return 0 on success, -1 if the function threw an exception
+template <typename Function>
+static int guarded(Function function)
+{
+    try
+    {
+        function();
+        last_error.clear();
+        return 0;
+    }
+    catch (const std::exception &e)
+    {
+        last_error = e.what();
+    }
+    catch (...)
+    {
+        last_error = "Error: Unknown error (Code: 150)";
+    }
+    return -1;
+}
+
+/// @brief Checks that a struct passed by the caller is large enough, before any of its fields are touched
+/// @param struct_size The struct_size set by the caller
+/// @param minimum_size The size the struct needs at least
+/// @param name Name of the struct for the error message
+static void check_struct_size(size_t struct_size, size_t minimum_size, const char *name)
+{
+    if (struct_size < minimum_size)
+        throw std::runtime_error("Error: struct_size of " + std::string(name) + " is " + std::to_string(struct_size) + " but has to be at least " + std::to_string(minimum_size) + " (Code: 155)");
+}
+
+/// @brief Converts the parameters of the C interface and checks them
+/// @param c_parameters The parameters passed by the caller
+/// @return The parameters of the simulator
+static PeriodicParameters convert_parameters(const nasch_parameters &c_parameters)
+{
+    check_struct_size(c_parameters.struct_size, NASCH_FIELD_END(nasch_parameters, autotune_cache), "nasch_parameters");
+    PeriodicParameters parameters;
+    parameters.street_length = c_parameters.street_length;
+    parameters.initial_cars = c_parameters.initial_cars;
+    parameters.vmax = c_parameters.vmax;
+    // the simulation runs as long as the caller performs steps
+    parameters.iterations = std::numeric_limits<int>::max();
+    parameters.dawdle_probability = c_parameters.dawdle_probability;
+    parameters.always_unlimited = c_parameters.always_unlimited != 0;
+    parameters.start_velocity_zero = c_parameters.start_velocity_zero != 0;
+    parameters.seed = c_parameters.seed;
+    parameters.output.csv = false;
+    if (c_parameters.struct_size >= NASCH_FIELD_END(nasch_parameters, fleet_file) && c_parameters.fleet_file)
+        parameters.vehicle_classes = Fleet::load(c_parameters.fleet_file);
+
+    std::string error = validate_periodic_parameters(parameters);
+    if (!error.empty())
+        throw std::runtime_error(error + " (Code: 151)");
+    if (c_parameters.threads < 0)
+        throw std::runtime_error("Error: Number of threads must not be negative (Code: 151)");
+
+    switch (c_parameters.engine)
+    {
+    case NASCH_ENGINE_CELLS:
+        parameters.engine = Engine::CELLS;
+        break;
+    case NASCH_ENGINE_CAR_LIST:
+        parameters.engine = Engine::CAR_LIST;
+        break;
+    case NASCH_ENGINE_AUTO:
+        parameters.engine = Engine::AUTO;
+        break;
+    default:
+        throw std::runtime_error("Error: Unknown engine " + std::to_string(c_parameters.engine) + " (Code: 152)");
+    }
+    parameters.threads = c_parameters.threads;
+    parameters.multicore = parameters.engine == Engine::CELLS && c_parameters.threads != 1;
+
+    if (parameters.engine == Engine::AUTO)
+        Autotuner(c_parameters.autotune_cache ? c_parameters.autotune_cache : "").tune(parameters);
+    return parameters;
+}
+
+extern "C"
+{
+    int nasch_api_version(void)
+    {
+        return NASCH_API_VERSION;
+    }
+
+    const char *nasch_last_error(void)
+    {
+        return last_error.c_str();
+    }
+
+    int nasch_default_parameters(nasch_parameters *parameters)
+    {
+        return guarded([&]
+                       {
+            if (!parameters)
+                throw std::runtime_error("Error: No parameters given (Code: 153)");
+            check_struct_size(parameters->struct_size, NASCH_FIELD_END(nasch_parameters, autotune_cache), "nasch_parameters");
+            parameters->street_length = 1000;
+            parameters->initial_cars = 100;
+            parameters->vmax = 5;
+            parameters->dawdle_probability = 0.2f;
+            parameters->always_unlimited = 0;
+            parameters->start_velocity_zero = 1;
+            parameters->seed = -1;
+            parameters->engine = NASCH_ENGINE_CELLS;
+            parameters->threads = 1;
+            parameters->autotune_cache = nullptr;
+            if (parameters->struct_size >= NASCH_FIELD_END(nasch_parameters, fleet_file))
+                parameters->fleet_file = nullptr; });
+    }
+
+    nasch_simulation *nasch_create(const nasch_parameters *parameters)
+    {
+        nasch_simulation *simulation = nullptr;
+        int result = guarded([&]
+                             {
+            if (!parameters)
+                throw std::runtime_error("Error: No parameters given (Code: 153)");
+            simulation = new nasch_simulation(convert_parameters(*parameters));
+            simulation->simulator.initialize_simulation();
+
+            // the classes of the cars do not change, so their max speeds are looked up once
+            for (const Car &car : simulation->simulator.get_cars())
+                simulation->max_speeds.push_back(simulation->simulator.get_fleet()[car.vehicle_class].max_speed); });
+        if (result != 0)
+        {
+            delete simulation;
+            return nullptr;
+        }
+        return simulation;
+    }
+
+    int nasch_step(nasch_simulation *simulation, int steps)
+    {
+        return guarded([&]
+                       {
+            if (!simulation)
+                throw std::runtime_error("Error: No simulation given (Code: 153)");
+            simulation->simulator.advance(steps); });
+    }
+
+    int nasch_get_view(const nasch_simulation *simulation, nasch_view *view)
+    {
+        return guarded([&]
+                       {
+            if (!simulation || !view)
+                throw std::runtime_error("Error: No simulation or view given (Code: 153)");
+            check_struct_size(view->struct_size, NASCH_FIELD_END(nasch_view, cell_stride), "nasch_view");
+            const std::vector<Car> &cars = simulation->simulator.get_cars();
+            const std::vector<Car *> &street = simulation->simulator.get_street();
+
+            // the fields of the cars are read in place, one car after the other
+            view->step = simulation->simulator.get_step();
+            view->street_length = street.size();
+            view->car_count = cars.size();
+            view->speeds = cars.empty() ? nullptr : &cars[0].speed;
+            view->positions = cars.empty() ? nullptr : &cars[0].position;
+            view->car_stride = sizeof(Car);
+            view->cells = reinterpret_cast<const void *const *>(street.data());
+            view->cell_stride = sizeof(Car *);
+            if (view->struct_size >= NASCH_FIELD_END(nasch_view, max_speed_stride))
+            {
+                view->max_speeds = cars.empty() ? nullptr : simulation->max_speeds.data();
+                view->vehicle_classes = cars.empty() ? nullptr : &cars[0].vehicle_class;
+                view->class_count = simulation->simulator.get_fleet().size();
+                view->max_speed_stride = sizeof(int);
+                return;
+            }
+
+            // a caller of version 1 reads the max speeds with car_stride
+            const size_t ints_per_car = sizeof(Car) / sizeof(int);
+            if (simulation->strided_max_speeds.empty() && !cars.empty())
+            {
+                simulation->strided_max_speeds.resize(cars.size() * ints_per_car);
+                for (size_t k = 0; k < cars.size(); k++)
+                    simulation->strided_max_speeds[k * ints_per_car] = simulation->max_speeds[k];
+            }
+            view->max_speeds = cars.empty() ? nullptr : simulation->strided_max_speeds.data(); });
+    }
+
+    int nasch_get_observables(const nasch_simulation *simulation, nasch_observables *observables)
+    {
+        return guarded([&]
+                       {
+            if (!simulation || !observables)
+                throw std::runtime_error("Error: No simulation or observables given (Code: 153)");
+            check_struct_size(observables->struct_size, sizeof(nasch_observables), "nasch_observables");
+            const std::vector<Car> &cars = simulation->simulator.get_cars();
+            long long speed_sum = 0;
+            int stopped_cars = 0;
+            for (const Car &car : cars)
+            {
+                speed_sum += car.speed;
+                if (car.speed == 0)
+                    stopped_cars++;
+            }
+
+            int street_length = simulation->simulator.get_parameters().street_length;
+            observables->step = simulation->simulator.get_step();
+            observables->cars = cars.size();
+            observables->stopped_cars = stopped_cars;
+            observables->density = static_cast<double>(cars.size()) / street_length;
+            observables->mean_speed = cars.empty() ? 0.0 : static_cast<double>(speed_sum) / cars.size();
+            observables->flow = static_cast<double>(speed_sum) / street_length; });
+    }
+
+    int nasch_get_vehicle_class(const nasch_simulation *simulation, int vehicle_class, nasch_vehicle_class *parameters)
+    {
+        return guarded([&]
+                       {
+            if (!simulation || !parameters)
+                throw std::runtime_error("Error: No simulation or vehicle class given (Code: 153)");
+            check_struct_size(parameters->struct_size, sizeof(nasch_vehicle_class), "nasch_vehicle_class");
+            const Fleet &fleet = simulation->simulator.get_fleet();
+            if (vehicle_class < 0 || vehicle_class >= fleet.size())
+                throw std::runtime_error("Error: Unknown vehicle class " + std::to_string(vehicle_class) + " (Code: 154)");
+            const ClassParameters &class_parameters = fleet[vehicle_class];
+            parameters->max_speed = class_parameters.max_speed;
+            parameters->acceleration = class_parameters.acceleration;
+            parameters->length = class_parameters.length;
+            parameters->dawdle_probability = class_parameters.dawdle_probability < 0 ? simulation->simulator.get_parameters().dawdle_probability : class_parameters.dawdle_probability; });
+    }
+
+    void nasch_destroy(nasch_simulation *simulation)
+    {
+        delete simulation;
+    }
+}
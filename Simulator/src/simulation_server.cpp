@@ -0,0 +1,438 @@
+#include "../include/simulation_server.h"
+#include "../include/argument_parser.h"
+
+// the server uses unix domain sockets and is therefore not available on windows
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <ctime>
+#include <cstring>
+#include <cstdio>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// linux reports a closed connection by EPIPE instead of SIGPIPE if this flag is given, mac uses SO_NOSIGPIPE instead
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// number of finished, cancelled or failed jobs kept for RESULT requests, older ones are forgotten
+#define MAX_RETAINED_JOBS 1024
+
+// #################################################################### //
+// ##################### CONSTRUCTOR & DESTRUCTOR ##################### //
+// #################################################################### //
+
+/// @brief Constructor to create the listening socket, the workers are started in run()
+/// @param socket_path Path of the unix domain socket
+/// @param thread_count Number of jobs that are simulated concurrently
+SimulationServer::SimulationServer(const std::string &socket_path, int thread_count) : socket_path(socket_path), thread_count(thread_count)
+{
+    if (thread_count <= 0)
+        throw std::runtime_error("Error: Number of server threads must be greater than 0 (Code: 301)");
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path))
+        throw std::runtime_error("Error: Socket path is too long (Code: 302)");
+    std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd == -1)
+        throw std::runtime_error("Error: Could not create socket (Code: 303)");
+
+    // remove a stale socket of a previous server
+    unlink(socket_path.c_str());
+    if (bind(listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == -1 || listen(listen_fd, 64) == -1)
+    {
+        close(listen_fd);
+        throw std::runtime_error("Error: Could not bind socket " + socket_path + " (Code: 304)");
+    }
+
+    // resolve the output directory once, every job writes to its own file in it
+    auto now = std::chrono::system_clock::now();
+    std::time_t now_time_t = std::chrono::system_clock::to_time_t(now);
+    std::tm local_tm = *std::localtime(&now_time_t);
+    char timeBuffer[20];
+    std::strftime(timeBuffer, sizeof(timeBuffer), "%d%m%Y_%H%M%S", &local_tm);
+    output_prefix = (SimulatorPeriodic::output_directory() / ("job_" + std::string(timeBuffer) + "_")).string();
+    autotuner = std::make_unique<Autotuner>(Autotuner::default_cache_file());
+}
+
+/// @brief Destructor to close and remove the socket
+SimulationServer::~SimulationServer()
+{
+    stop();
+    if (listen_fd != -1)
+        close(listen_fd);
+    unlink(socket_path.c_str());
+}
+
+// ##################################################################### //
+// ############################## METHODS ############################## //
+// ##################################################################### //
+
+// ====================================================== //
+// ================= Server-Loop-Methods ================ //
+// ====================================================== //
+
+/// @brief Method to start the workers and accept connections until the server is stopped
+void SimulationServer::run()
+{
+    for (int i = 0; i < thread_count; i++)
+        workers.emplace_back(&SimulationServer::worker_loop, this);
+
+    while (!stopping)
+    {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd == -1)
+        {
+            if (stopping)
+                break;
+            continue;
+        }
+#ifdef SO_NOSIGPIPE
+        int no_sigpipe = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+        // every client gets its own thread, so WAIT requests do not block other clients
+        std::lock_guard<std::mutex> lock(connection_mutex);
+        connection_fds.push_back(fd);
+        std::thread(&SimulationServer::handle_connection, this, fd).detach();
+    }
+
+    // cancel all jobs and wait for the workers
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        for (auto &[id, job] : jobs)
+            job->cancel_requested = true;
+    }
+    job_available.notify_all();
+    job_done.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+    workers.clear();
+
+    // disconnect the clients and wait for their threads
+    std::unique_lock<std::mutex> lock(connection_mutex);
+    for (int fd : connection_fds)
+        shutdown(fd, SHUT_RDWR);
+    connections_closed.wait(lock, [this]
+                            { return connection_fds.empty(); });
+}
+
+/// @brief Method to stop the server, run() returns after the running jobs were cancelled
+void SimulationServer::stop()
+{
+    if (stopping.exchange(true))
+        return;
+    // wakes up the blocking accept() in run()
+    shutdown(listen_fd, SHUT_RDWR);
+    {
+        // taking the lock makes sure no waiting thread misses the notification
+        std::lock_guard<std::mutex> lock(job_mutex);
+    }
+    job_available.notify_all();
+    job_done.notify_all();
+}
+
+/// @brief Method executed by every worker thread, each worker reuses one simulator for all its jobs
+void SimulationServer::worker_loop()
+{
+    SimulatorPeriodic simulator(PeriodicParameters{});
+
+    while (true)
+    {
+        std::shared_ptr<SimulationJob> job;
+        {
+            std::unique_lock<std::mutex> lock(job_mutex);
+            job_available.wait(lock, [this]
+                               { return stopping || !queue.empty(); });
+            if (stopping)
+                return;
+            job = queue.front();
+            queue.pop_front();
+            if (job->cancel_requested)
+            {
+                job->state = JobState::CANCELLED;
+                retire_job(*job);
+                job_done.notify_all();
+                continue;
+            }
+            job->state = JobState::RUNNING;
+        }
+
+        // run the job, inline results are collected in memory
+        std::ostringstream inline_output;
+        JobState state = JobState::FINISHED;
+        std::string error;
+        try
+        {
+            autotuner->tune(job->parameters);
+            simulator.reset(job->parameters);
+            simulator.set_output_stream(job->inline_result ? &inline_output : nullptr);
+            simulator.set_progress_callback([&job](int finished_iterations)
+                                            {
+                job->finished_iterations = finished_iterations;
+                return !job->cancel_requested; });
+            simulator.perform_simulation();
+            if (simulator.was_cancelled())
+                state = JobState::CANCELLED;
+        }
+        // any exception only fails the job (e.g. bad_alloc for a huge street), never the whole server
+        catch (const std::exception &e)
+        {
+            state = JobState::FAILED;
+            error = e.what();
+        }
+        catch (...)
+        {
+            state = JobState::FAILED;
+            error = "Error: Unknown error";
+        }
+
+        // the reserved file of an inline job stays empty, it is only kept while it reserves the names of the jam and keyframe files
+        if (job->inline_result && !job->parameters.jams.enabled && job->parameters.keyframes.interval == 0)
+            std::remove(job->parameters.output_file_name.c_str());
+
+        std::lock_guard<std::mutex> lock(job_mutex);
+        job->state = state;
+        job->error = error;
+        job->result = job->inline_result ? inline_output.str() : job->parameters.output_file_name;
+        retire_job(*job);
+        job_done.notify_all();
+    }
+}
+
+// ====================================================== //
+// ================== Protocol-Methods ================== //
+// ====================================================== //
+
+/// @brief Method to read requests line by line from a client and answer them
+/// @param fd The socket of the client
+void SimulationServer::handle_connection(int fd)
+{
+    std::string buffer;
+    char chunk[4096];
+    bool open = true;
+    while (open)
+    {
+        ssize_t count = read(fd, chunk, sizeof(chunk));
+        if (count <= 0)
+            break;
+        buffer.append(chunk, count);
+
+        // answer every complete line
+        size_t newline;
+        while ((newline = buffer.find('\n')) != std::string::npos)
+        {
+            std::string line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+
+            std::string response = handle_request(line);
+            size_t written = 0;
+            while (written < response.size())
+            {
+                // a client that disconnected before its response arrived must not kill the server with SIGPIPE
+                ssize_t sent = send(fd, response.data() + written, response.size() - written, MSG_NOSIGNAL);
+                if (sent <= 0)
+                {
+                    // EPIPE or any other error closes the connection
+                    open = false;
+                    break;
+                }
+                written += sent;
+            }
+            if (!open || line == "SHUTDOWN")
+            {
+                open = false;
+                break;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(connection_mutex);
+    for (auto it = connection_fds.begin(); it != connection_fds.end(); it++)
+    {
+        if (*it == fd)
+        {
+            connection_fds.erase(it);
+            break;
+        }
+    }
+    close(fd);
+    connections_closed.notify_all();
+}
+
+/// @brief Method to answer a single request
+/// @param line The request without the newline
+/// @return The response including the trailing newline
+std::string SimulationServer::handle_request(const std::string &line)
+{
+    std::istringstream stream(line);
+    std::vector<std::string> tokens;
+    for (std::string token; stream >> token;)
+        tokens.push_back(token);
+    if (tokens.empty())
+        return "ERROR empty request\n";
+
+    const std::string &command = tokens[0];
+    if (command == "RUN")
+        return submit_job(tokens);
+    if (command == "SHUTDOWN")
+    {
+        stop();
+        return "OK\n";
+    }
+    if (tokens.size() != 2)
+        return "ERROR usage: " + command + " <job_id>\n";
+
+    std::shared_ptr<SimulationJob> job = find_job(tokens[1]);
+    if (!job)
+        return "ERROR unknown job " + tokens[1] + "\n";
+
+    if (command == "STATUS")
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        return describe_job(*job);
+    }
+    if (command == "WAIT")
+    {
+        std::unique_lock<std::mutex> lock(job_mutex);
+        job_done.wait(lock, [this, &job]
+                      { return stopping || (job->state != JobState::QUEUED && job->state != JobState::RUNNING); });
+        return describe_job(*job);
+    }
+    if (command == "CANCEL")
+    {
+        // a job that is already done is forgotten, a queued or running job is forgotten after its RESULT
+        std::lock_guard<std::mutex> lock(job_mutex);
+        job->cancel_requested = true;
+        if (job->state != JobState::QUEUED && job->state != JobState::RUNNING)
+            jobs.erase(job->id);
+        return "OK " + tokens[1] + "\n";
+    }
+    if (command == "RESULT")
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        if (job->state == JobState::QUEUED || job->state == JobState::RUNNING)
+            return "ERROR job " + tokens[1] + " is not finished\n";
+        // the result is delivered only once, afterwards the job is forgotten
+        jobs.erase(job->id);
+        if (job->state == JobState::FAILED)
+            return "ERROR job " + tokens[1] + " failed: " + job->error + "\n";
+        if (job->state == JobState::CANCELLED)
+            return "ERROR job " + tokens[1] + " was cancelled\n";
+        if (job->inline_result)
+            return "RESULT " + tokens[1] + " INLINE " + std::to_string(job->result.size()) + "\n" + job->result;
+        return "RESULT " + tokens[1] + " FILE " + job->result + "\n";
+    }
+    return "ERROR unknown command " + command + "\n";
+}
+
+/// @brief Method to parse a RUN request and queue the job
+/// @param tokens The tokens of the request including the command
+/// @return The response containing the job id
+std::string SimulationServer::submit_job(const std::vector<std::string> &tokens)
+{
+    auto job = std::make_shared<SimulationJob>();
+    job->inline_result = false;
+
+    // split the positional arguments from the options
+    std::vector<std::string> arguments;
+    std::vector<std::string> options;
+    std::string output_file_name;
+    for (size_t i = 1; i < tokens.size(); i++)
+    {
+        if (tokens[i] == "--inline")
+            job->inline_result = true;
+        else if (tokens[i].rfind("--output=", 0) == 0)
+            output_file_name = tokens[i].substr(9);
+        else if (tokens[i].rfind("--", 0) == 0)
+            options.push_back(tokens[i]);
+        else
+            arguments.push_back(tokens[i]);
+    }
+
+    std::string error = parse_periodic_arguments(arguments, job->parameters);
+    if (error.empty())
+        error = parse_options(options, job->parameters);
+    if (error.empty() && job->inline_result && !output_file_name.empty())
+        error = "Error: --output and --inline can not be combined";
+    if (!error.empty())
+        return "ERROR " + error + "\n";
+
+    std::lock_guard<std::mutex> lock(job_mutex);
+    if (stopping)
+        return "ERROR server is shutting down\n";
+    job->id = next_job_id++;
+    // the file is created right away, so a second server started in the same second can not pick the same name
+    // (inline jobs need the name as well, the jam and keyframe files are derived from it)
+    if (!output_file_name.empty())
+        job->parameters.output_file_name = output_file_name;
+    else
+    {
+        try
+        {
+            job->parameters.output_file_name = SimulatorPeriodic::reserve_output_file_name(output_prefix + std::to_string(job->id));
+        }
+        catch (const std::runtime_error &e)
+        {
+            return "ERROR " + std::string(e.what()) + "\n";
+        }
+    }
+    jobs[job->id] = job;
+    queue.push_back(job);
+    job_available.notify_one();
+    return "OK " + std::to_string(job->id) + "\n";
+}
+
+/// @brief Method to describe the state and progress of a job, the job mutex has to be held
+/// @param job The job to describe
+/// @return The STATUS response
+std::string SimulationServer::describe_job(const SimulationJob &job)
+{
+    static const char *state_names[] = {"queued", "running", "finished", "cancelled", "failed"};
+    return "STATUS " + std::to_string(job.id) + " " + state_names[static_cast<int>(job.state)] + " " +
+           std::to_string(job.finished_iterations) + "/" + std::to_string(job.parameters.iterations) + "\n";
+}
+
+/// @brief Method to remember a job that is done, the oldest done jobs are forgotten if too many results are not fetched.
+/// The job mutex has to be held.
+/// @param job The job that is finished, cancelled or failed
+void SimulationServer::retire_job(const SimulationJob &job)
+{
+    retired_jobs.push_back(job.id);
+    while (retired_jobs.size() > MAX_RETAINED_JOBS)
+    {
+        // jobs whose result was already fetched are not in the map anymore
+        jobs.erase(retired_jobs.front());
+        retired_jobs.pop_front();
+    }
+}
+
+/// @brief Method to look up a job by its id
+/// @param id The id as sent by the client
+/// @return The job or nullptr if there is no job with this id
+std::shared_ptr<SimulationJob> SimulationServer::find_job(const std::string &id)
+{
+    int job_id;
+    try
+    {
+        job_id = std::stoi(id);
+    }
+    catch (const std::exception &)
+    {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(job_mutex);
+    auto it = jobs.find(job_id);
+    return it == jobs.end() ? nullptr : it->second;
+}
+
+#endif
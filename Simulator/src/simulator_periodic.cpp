@@ -7,6 +7,12 @@
 #include <ctime>
 #include <algorithm>
 #include <unistd.h>
+#include <climits>
+#include <thread>
+#include <mutex>
+#include <exception>
+#include <cstdio>
+#include <cerrno>
 #ifdef _WIN32
 #include <windows.h>
 #elif __APPLE__
@@ -15,6 +21,16 @@
 #include <unistd.h>
 #endif
 
+/// @brief Checks if a cell holds the front of a vehicle, the other cells of a long vehicle hold the same car
+/// @param street The street, the cell has to be occupied
+/// @param i The index of the cell
+/// @return true if the cell in front belongs to another vehicle or is empty
+static inline bool is_front(const std::vector<Car *> &street, int i)
+{
+    int next = i + 1 == static_cast<int>(street.size()) ? 0 : i + 1;
+    return street[next] != street[i] || next == i;
+}
+
 // #################################################################### //
 // ##################### CONSTRUCTOR & DESTRUCTOR ##################### //
 // #################################################################### //
@@ -30,7 +46,77 @@ SimulatorPeriodic::SimulatorPeriodic(int street_length, int initial_cars, int vm
     parameters.start_velocity_zero = start_velocity_zero;
     parameters.multicore = multicore;
 
-// generate the output file name in the format "output_YYYYMMDD_HHMMSS.csv"
+    // generate the output file name in the format "output_YYYYMMDD_HHMMSS.csv"
+    parameters.output_file_name = default_output_file_name();
+}
+
+/// @brief Constructor to create a simulator from already validated parameters (the output file name has to be set by the caller)
+/// @param parameters The parameters of the simulation
+SimulatorPeriodic::SimulatorPeriodic(const PeriodicParameters &parameters) : parameters(parameters) {}
+
+SimulatorPeriodic::~SimulatorPeriodic() {}
+
+// ##################################################################### //
+// ############################## METHODS ############################## //
+// ##################################################################### //
+
+// ====================================================== //
+// ================== Lifecycle-Methods ================= //
+// ====================================================== //
+
+/// @brief Method to prepare the simulator for another run, the street buffers keep their capacity
+/// @param parameters The parameters of the next run
+void SimulatorPeriodic::reset(const PeriodicParameters &parameters)
+{
+    clear_streets();
+    this->parameters = parameters;
+    cancelled = false;
+
+    // close the output files of a run that was aborted by an exception
+    if (output_file.is_open())
+        output_file.close();
+    output_file.clear();
+    renderer.reset();
+    jam_tracker.reset();
+    keyframe_store.reset();
+}
+
+/// @brief Method to write the results to the given stream instead of the output file
+/// @param stream The stream to write to, nullptr to write to the output file again
+void SimulatorPeriodic::set_output_stream(std::ostream *stream)
+{
+    external_output_stream = stream;
+}
+
+/// @brief Method to set a callback which is called after every iteration
+/// @param callback Gets the number of finished iterations, returning false cancels the simulation
+void SimulatorPeriodic::set_progress_callback(std::function<bool(int)> callback)
+{
+    progress_callback = std::move(callback);
+}
+
+/// @brief Method to check if the last run was cancelled by the progress callback
+/// @return true if the last run was cancelled
+bool SimulatorPeriodic::was_cancelled() const
+{
+    return cancelled;
+}
+
+/// @brief Method to delete all cars and empty both streets
+void SimulatorPeriodic::clear_streets()
+{
+    std::fill(reading_street.begin(), reading_street.end(), nullptr);
+    std::fill(writing_street.begin(), writing_street.end(), nullptr);
+    car_list.clear();
+    car_positions.clear();
+    jam_order.clear();
+    cars.clear();
+}
+
+/// @brief Method to find the output directory next to the executable, creates it if it does not exist
+/// @return The path of the output directory
+std::filesystem::path SimulatorPeriodic::output_directory()
+{
 // find the directory of the executable
 
 // for windows systems
@@ -72,6 +158,14 @@ SimulatorPeriodic::SimulatorPeriodic(int street_length, int initial_cars, int vm
         if (!std::filesystem::create_directory(outputDir))
             throw std::runtime_error("Error: Could not create output directory (Code: 114)");
     }
+    return outputDir;
+}
+
+/// @brief Method to generate a new output file name in the format "output_DDMMYYYY_HHMMSS.csv"
+/// @return The full path of the output file, a counter is appended if a run in the same second already used the name
+std::string SimulatorPeriodic::default_output_file_name()
+{
+    std::filesystem::path outputDir = output_directory();
 
     // get current date and time
     auto now = std::chrono::system_clock::now();
@@ -82,37 +176,41 @@ SimulatorPeriodic::SimulatorPeriodic(int street_length, int initial_cars, int vm
     char timeBuffer[20];
     std::strftime(timeBuffer, sizeof(timeBuffer), "%d%m%Y_%H%M%S", &local_tm);
 
-    // create the output file name
-    std::filesystem::path filePath = outputDir / ("output_" + std::string(timeBuffer) + ".csv");
-    parameters.output_file_name = filePath.string();
+    // create the output file, a counter is appended if another run already took the name
+    return reserve_output_file_name((outputDir / ("output_" + std::string(timeBuffer))).string());
 }
 
-/// @brief Destructor to delete the cars from the street
-SimulatorPeriodic::~SimulatorPeriodic()
+/// @brief Method to reserve a new output file by creating it, so runs started at the same time never share a file
+/// @param stem Path of the file without the extension
+/// @return The full path of the created (empty) file, "_N" is appended to the stem if the name is already taken
+std::string SimulatorPeriodic::reserve_output_file_name(const std::string &stem)
 {
-    for (Car *car : reading_street)
-    {
-        if (car)
-            delete car;
-    }
-    for (Car *car : writing_street)
+    for (int counter = 0;; counter++)
     {
-        if (car)
-            delete car;
+        std::string file_name = stem + (counter == 0 ? "" : "_" + std::to_string(counter)) + ".csv";
+        // the mode "x" fails if the file exists, so checking and creating the file is a single atomic step
+        if (FILE *file = std::fopen(file_name.c_str(), "wx"))
+        {
+            std::fclose(file);
+            return file_name;
+        }
+        if (errno != EEXIST)
+            throw std::runtime_error("Error: Could not create output file " + file_name + " (Code: 110)");
     }
 }
 
-// ##################################################################### //
-// ############################## METHODS ############################## //
-// ##################################################################### //
-
 // ====================================================== //
 // ================ Simulation-Run-Method =============== //
 // ====================================================== //
 
 void SimulatorPeriodic::perform_simulation()
 {
-    if (parameters.multicore)
+    if (parameters.engine == Engine::AUTO)
+        throw std::runtime_error("Error: The engine has to be chosen by the autotuner before the simulation is started (Code: 116)");
+
+    if (parameters.engine == Engine::CAR_LIST)
+        perform_simulation_car_list();
+    else if (parameters.multicore)
         perform_simulation_multicore();
     else
         perform_simulation_singlecore();
@@ -121,40 +219,429 @@ void SimulatorPeriodic::perform_simulation()
 /// @brief Method to perform the simulation without multicore support
 void SimulatorPeriodic::perform_simulation_singlecore()
 {
-    // initialize a random number generator
-    std::random_device rd;
-    std::mt19937 rng(rd());
+    // fill the street and write the parameters and the initial state of the street to the output file
+    initialize_simulation();
+    begin_output();
+
+    // perform the simulation steps for the given number of iterations
+    run_cells(parameters.iterations);
+    close_output();
+}
 
+/// @brief Method to replay the steps between first_step and last_step from the nearest keyframe before them
+/// @param store The keyframes of the recorded simulation, the parameters of the simulator have to match them
+/// @param first_step The first step that is written to the output
+/// @param last_step The last step that is written to the output
+void SimulatorPeriodic::perform_replay(KeyframeStore &store, int first_step, int last_step)
+{
+    if (first_step < 0 || first_step > last_step)
+        throw std::runtime_error("Error: Invalid replay range from " + std::to_string(first_step) + " to " + std::to_string(last_step) + " (Code: 117)");
+
+    // restore the nearest keyframe, the steps up to first_step are simulated without output
+    Keyframe start = store.read_nearest(first_step);
+    restore_keyframe(start);
+
+    open_output();
+    print_parameters();
+    for (int step = start.step;; step++)
+    {
+        if (step >= first_step && (step - first_step) % parameters.output.time_stride == 0)
+            print_street(reading_street);
+        if (step == last_step)
+            break;
+        step_cells();
+    }
+    close_output();
+}
+
+/// @brief Method to perform the simulation with the street split into one section per thread
+void SimulatorPeriodic::perform_simulation_multicore()
+{
+    // fill the street and write the parameters and the initial state of the street to the output file
+    initialize_simulation();
+    begin_output();
+
+    run_multicore(parameters.iterations);
+    close_output();
+}
+
+/// @brief Method to perform the simulation on a list of the cars ordered by their position
+void SimulatorPeriodic::perform_simulation_car_list()
+{
+    // fill the street and write the parameters and the initial state of the street to the output file
+    initialize_simulation();
+    build_car_list();
+    begin_output();
+
+    run_car_list(parameters.iterations);
+    close_output();
+}
+
+/// @brief Method to seed the random number generator and fill the street, the outputs are not opened
+void SimulatorPeriodic::initialize_simulation()
+{
+    if (parameters.engine == Engine::AUTO)
+        throw std::runtime_error("Error: The engine has to be chosen by the autotuner before the simulation is started (Code: 116)");
+
+    clear_streets();
+    thread_rngs.clear();
+    current_step = 0;
+    cancelled = false;
+
+    // initialize the random number generator and the table of the vehicle classes
+    seed_rng();
+    build_fleet();
     // initialize the street
     initialize_street();
     // fill the street with the initial cars
     fill_street(reading_street);
+}
+
+/// @brief Method to perform further steps with the engine of the parameters, initialize_simulation has to be called first
+/// @param steps Number of steps to perform
+void SimulatorPeriodic::advance(int steps)
+{
+    if (steps < 0)
+        throw std::runtime_error("Error: Number of steps must not be negative (Code: 119)");
+
+    if (parameters.engine == Engine::CAR_LIST)
+        run_car_list(steps);
+    else if (parameters.multicore)
+        run_multicore(steps);
+    else
+        run_cells(steps);
+}
+
+/// @brief Method to get the number of steps performed since the street was filled
+int SimulatorPeriodic::get_step() const
+{
+    return current_step;
+}
+
+/// @brief Method to get the cars, the positions and speeds are valid until the next step
+const std::vector<Car> &SimulatorPeriodic::get_cars() const
+{
+    return cars;
+}
+
+/// @brief Method to get the street with a pointer to the car in every occupied cell
+const std::vector<Car *> &SimulatorPeriodic::get_street() const
+{
+    return reading_street;
+}
+
+/// @brief Method to get the parameters of the simulation
+const PeriodicParameters &SimulatorPeriodic::get_parameters() const
+{
+    return parameters;
+}
+
+/// @brief Method to get the table of the vehicle classes
+const Fleet &SimulatorPeriodic::get_fleet() const
+{
+    return fleet;
+}
+
+/// @brief Method to perform steps on the street of cells in a single thread
+/// @param steps Number of steps to perform
+void SimulatorPeriodic::run_cells(int steps)
+{
+    for (int i = 0; i < steps; i++)
+    {
+        step_cells();
+
+        // write the new state and report the progress, stop if the run was cancelled
+        if (!finish_step(++current_step))
+            break;
+    }
+}
+
+/// @brief Method to perform steps with the street split into one section per thread
+/// @param steps Number of steps to perform
+void SimulatorPeriodic::run_multicore(int steps)
+{
+    // every thread works on its own section of the street, each section has at least one cell
+    int thread_count = parameters.threads > 0 ? parameters.threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    thread_count = std::min(thread_count, parameters.street_length);
+
+    // every thread needs its own random number generator, derived from the seed of the run
+    if (static_cast<int>(thread_rngs.size()) != thread_count)
+    {
+        thread_rngs.clear();
+        for (int t = 0; t < thread_count; t++)
+        {
+            std::seed_seq sequence{used_seed, static_cast<unsigned int>(t + 1)};
+            thread_rngs.emplace_back(sequence);
+        }
+    }
+
+    // the threads are only started again if their number changes, e.g. after reset
+    if (!worker_pool || worker_pool->size() != thread_count)
+    {
+        worker_pool.reset();
+        worker_pool = std::make_unique<WorkerPool>(thread_count);
+        barrier = std::make_unique<Barrier>(thread_count);
+    }
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    bool stop = false;
+
+    // swaps the streets after a phase, runs in the last thread arriving at the barrier
+    auto swap = [this]
+    { std::swap(reading_street, writing_street); };
+    // writes the new state after a step, also runs in the last thread arriving at the barrier
+    auto finish = [this, &error, &stop]
+    {
+        std::swap(reading_street, writing_street);
+        try
+        {
+            if (!error && !finish_step(++current_step))
+                stop = true;
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        stop = stop || error;
+    };
+
+    std::function<void(int)> work = [&, this](int thread_index)
+    {
+        int start_index = static_cast<long long>(parameters.street_length) * thread_index / thread_count;
+        int end_index = static_cast<long long>(parameters.street_length) * (thread_index + 1) / thread_count - 1;
+        CountingRng &rng = thread_rngs[thread_index];
+
+        // an exception stops the work of this thread, but it keeps arriving at the barriers so the others can finish the step
+        bool failed = false;
+        auto run_phase = [&](const std::function<void()> &phase)
+        {
+            if (failed)
+                return;
+            try
+            {
+                phase();
+            }
+            catch (...)
+            {
+                failed = true;
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+        };
+        // clears this section of the writing street, the other threads only read the reading street
+        auto clear_section = [&]
+        { std::fill(writing_street.begin() + start_index, writing_street.begin() + end_index + 1, nullptr); };
+
+        for (int i = 0; i < steps; i++)
+        {
+            run_phase([&]
+                      { clear_section(); accelerate_cars(reading_street, writing_street, start_index, end_index); });
+            barrier->arrive_and_wait(swap);
+            run_phase([&]
+                      { clear_section(); decelerate_cars(reading_street, writing_street, start_index, end_index); });
+            barrier->arrive_and_wait(swap);
+            run_phase([&]
+                      { clear_section(); dawdle_cars(reading_street, writing_street, start_index, end_index, parameters.dawdle_probability, rng); });
+            barrier->arrive_and_wait(swap);
+            // the cars can move into the section of another thread, so all sections have to be cleared before moving
+            run_phase(clear_section);
+            barrier->arrive_and_wait();
+            run_phase([&]
+                      { move_cars(reading_street, writing_street, start_index, end_index); });
+            barrier->arrive_and_wait(finish);
+            if (stop)
+                break;
+        }
+    };
+
+    worker_pool->run(work);
+
+    // empty the writing street again, it can still hold the cars of the last phase
+    std::fill(writing_street.begin(), writing_street.end(), nullptr);
+    if (error)
+        std::rethrow_exception(error);
+}
+
+/// @brief Method to perform steps on the list of the cars ordered by their position
+/// @param steps Number of steps to perform
+void SimulatorPeriodic::run_car_list(int steps)
+{
+    // the list is built on the first call after the street was filled
+    if (car_list.size() != cars.size())
+        build_car_list();
+
+    for (int i = 0; i < steps; i++)
+    {
+        step_car_list(rng);
 
-    // write the parameters and the initial state of the street to the output file
+        // write the new state and report the progress, stop if the run was cancelled
+        if (!finish_step(++current_step))
+            break;
+    }
+}
+
+/// @brief Method to collect the cars in the order of their position, the street is only kept up to date for the output
+void SimulatorPeriodic::build_car_list()
+{
+    car_list.clear();
+    car_positions.clear();
+    for (int i = 0; i < parameters.street_length; i++)
+    {
+        if (!reading_street[i] || !is_front(reading_street, i))
+            continue;
+        car_list.push_back(reading_street[i]);
+        car_positions.push_back(i);
+    }
+}
+
+/// @brief Method to open the outputs and write the parameters and the initial state
+void SimulatorPeriodic::begin_output()
+{
+    open_output();
     print_parameters();
     print_street(reading_street);
+    track_jams(0);
+    if (keyframe_store)
+        save_keyframe(0);
+}
 
-    // perform the simulation steps for the given number of iterations
-    for (int i = 0; i < parameters.iterations; i++)
-    {
-        // accelerate the cars
-        accelerate_cars(reading_street, writing_street, 0, reading_street.size() - 1);
-        // decelerate the cars
-        decelerate_cars(reading_street, writing_street, 0, reading_street.size() - 1);
-        // dawdle the cars
-        dawdle_cars(reading_street, writing_street, 0, reading_street.size() - 1, parameters.dawdle_probability, rng);
-        // move the cars
-        move_cars(reading_street, writing_street, 0, reading_street.size() - 1);
-
-        // write the new state of the street to the output file
-        print_street(reading_street);
+/// @brief Method to initialize the random number generator with the seed of the parameters (or a random seed)
+void SimulatorPeriodic::seed_rng()
+{
+    if (parameters.seed >= 0)
+        used_seed = static_cast<unsigned int>(parameters.seed);
+    else
+        used_seed = std::random_device()();
+    rng.seed(used_seed);
+}
+
+/// @brief Method to build the table of the vehicle classes from the parameters
+void SimulatorPeriodic::build_fleet()
+{
+    if (parameters.vehicle_classes.empty())
+        fleet = Fleet(Fleet::default_classes(parameters.always_unlimited, parameters.vmax));
+    else
+        fleet = Fleet(parameters.vehicle_classes);
+}
+
+/// @brief Method to write the current state and the state of the random number generator to the keyframe file
+/// @param step The number of the step
+void SimulatorPeriodic::save_keyframe(int step)
+{
+    keyframe_buffer.step = step;
+    keyframe_buffer.rng_count = rng.get_count();
+    keyframe_buffer.positions.clear();
+    keyframe_buffer.speeds.clear();
+    keyframe_buffer.vehicle_classes.clear();
+    for (int i = 0; i < parameters.street_length; i++)
+    {
+        if (!reading_street[i] || !is_front(reading_street, i))
+            continue;
+        keyframe_buffer.positions.push_back(i);
+        keyframe_buffer.speeds.push_back(reading_street[i]->speed);
+        keyframe_buffer.vehicle_classes.push_back(reading_street[i]->vehicle_class);
     }
+    keyframe_store->write(keyframe_buffer);
 }
 
-void SimulatorPeriodic::perform_simulation_multicore()
+/// @brief Method to restore the street and the random number generator from a keyframe
+/// @param keyframe The keyframe to restore
+void SimulatorPeriodic::restore_keyframe(const Keyframe &keyframe)
 {
-    // TO BE IMPLIMENTED
+    clear_streets();
+    build_fleet();
+    initialize_street();
+    // the streets point into the cars, so they must not be reallocated
+    cars.reserve(keyframe.positions.size());
+    for (size_t k = 0; k < keyframe.positions.size(); k++)
+    {
+        if (keyframe.positions[k] < 0 || keyframe.positions[k] >= parameters.street_length || keyframe.vehicle_classes[k] < 0 || keyframe.vehicle_classes[k] >= fleet.size())
+            throw std::runtime_error("Error: Keyframe car at position " + std::to_string(keyframe.positions[k]) + " is outside of the street or has an unknown class (Code: 118)");
+        cars.emplace_back(keyframe.vehicle_classes[k], keyframe.speeds[k]);
+        cars.back().position = keyframe.positions[k];
+        for (int j = 0; j < fleet[keyframe.vehicle_classes[k]].length; j++)
+            reading_street[(keyframe.positions[k] - j + parameters.street_length) % parameters.street_length] = &cars.back();
+    }
+    current_step = keyframe.step;
+    // the parameters of a keyframe file hold the seed of the recorded simulation
+    used_seed = static_cast<unsigned int>(parameters.seed);
+    rng.restore(used_seed, keyframe.rng_count);
+}
+
+/// @brief Method to pass the current cars to the jam tracker (if enabled)
+/// @param step The number of the step
+void SimulatorPeriodic::track_jams(int step)
+{
+    if (!jam_tracker)
+        return;
+
+    // the car list engine already has the cars in the order of their position
+    jam_positions.clear();
+    jam_speeds.clear();
+    jam_lengths.clear();
+    if (parameters.engine == Engine::CAR_LIST)
+    {
+        jam_positions.insert(jam_positions.end(), car_positions.begin(), car_positions.end());
+        for (Car *car : car_list)
+        {
+            jam_speeds.push_back(car->speed);
+            jam_lengths.push_back(fleet[car->vehicle_class].length);
+        }
+    }
+    else
+    {
+        // the cars can not pass each other, so their order along the street is sorted once and the cars
+        // are then passed from the one with the lowest position on, without scanning the street
+        if (jam_order.size() != cars.size())
+        {
+            jam_order.clear();
+            for (Car &car : cars)
+                jam_order.push_back(&car);
+            std::sort(jam_order.begin(), jam_order.end(), [](const Car *a, const Car *b)
+                      { return a->position < b->position; });
+        }
+        size_t first = 0;
+        for (size_t k = 1; k < jam_order.size(); k++)
+        {
+            if (jam_order[k]->position < jam_order[k - 1]->position)
+            {
+                first = k;
+                break;
+            }
+        }
+        for (size_t offset = 0; offset < jam_order.size(); offset++)
+        {
+            const Car *car = jam_order[(first + offset) % jam_order.size()];
+            jam_positions.push_back(car->position);
+            jam_speeds.push_back(car->speed);
+            jam_lengths.push_back(fleet[car->vehicle_class].length);
+        }
+    }
+    jam_tracker->observe(step, jam_positions, jam_speeds, jam_lengths);
+}
+
+/// @brief Method to write the state after a step to the outputs and report the progress
+/// @param finished_iterations Number of finished iterations
+/// @return false if the run was cancelled
+bool SimulatorPeriodic::finish_step(int finished_iterations)
+{
+    // write the new state of the street to the output file (only every time_stride-th step)
+    if (finished_iterations % parameters.output.time_stride == 0)
+        print_street(reading_street);
+    track_jams(finished_iterations);
+    if (keyframe_store && finished_iterations % parameters.keyframes.interval == 0)
+        save_keyframe(finished_iterations);
+
+    // report the progress and stop if the run was cancelled
+    if (progress_callback && !progress_callback(finished_iterations))
+    {
+        cancelled = true;
+        return false;
+    }
+    return true;
 }
+
 // ====================================================== //
 // ================= Initializer-Methods ================ //
 // ====================================================== //
@@ -174,40 +661,75 @@ void SimulatorPeriodic::fill_street(std::vector<Car *> &street)
     if (parameters.initial_cars > static_cast<int>(street.size()))
         throw std::runtime_error("Error: Number of initial cars exceeds street size (Code: 111)");
 
-    // Create a random number generator
-    std::random_device rd;
-    std::mt19937 rng(rd());
-
-    // Create a distribution to get a random number between 0 and the street length
-    std::uniform_int_distribution<> dis(0, street.size() - 1);
+    // the classes of long vehicles have to be known before placing them, a fleet of single cell vehicles draws them
+    // together with the start speed (in the same order as before there were fleets)
+    std::vector<unsigned char> vehicle_classes;
+    int extra_cells = 0;
+    if (fleet.get_max_length() > 1)
+    {
+        for (int i = 0; i < parameters.initial_cars; i++)
+        {
+            vehicle_classes.push_back(fleet.draw(rng));
+            int length = fleet[vehicle_classes.back()].length;
+            if (length > 1 && length >= static_cast<int>(street.size()))
+                throw std::runtime_error("Error: Vehicle of length " + std::to_string(length) + " does not fit on the street (Code: 111)");
+            extra_cells += length - 1;
+        }
+        if (parameters.initial_cars + extra_cells > static_cast<int>(street.size()))
+            throw std::runtime_error("Error: The initial vehicles need " + std::to_string(parameters.initial_cars + extra_cells) + " cells, more than the street has (Code: 111)");
+    }
 
-    // generate a vector with the indices of the street
-    std::vector<int> indices(street.size());
+    // generate a vector with the indices of the street without the extra cells of the long vehicles
+    std::vector<int> indices(street.size() - extra_cells);
     std::iota(indices.begin(), indices.end(), 0);
     // shuffle the indices to get a random order
     std::shuffle(indices.begin(), indices.end(), rng);
 
-    // iterate over the indices and place a car at the index
+    // the streets point into the cars, so they must not be reallocated
+    cars.clear();
+    cars.reserve(parameters.initial_cars);
+
+    // iterate over the indices and create a car for the index
     for (int i = 0; i < parameters.initial_cars; i++)
     {
-        // create a new car and place it at the index
-        if (parameters.always_unlimited){
-            street[indices[i]] = new Car(parameters.start_velocity_zero, true, rng);
-        }
-        else if (parameters.always_unlimited == false && parameters.vmax == -1) {
-            street[indices[i]] = new Car(parameters.start_velocity_zero, false, rng);
-        }
-        else {
-            street[indices[i]] = new Car(parameters.start_velocity_zero, parameters.vmax, rng);
+        unsigned char vehicle_class = vehicle_classes.empty() ? fleet.draw(rng) : vehicle_classes[i];
+        int speed = 0;
+        if (!parameters.start_velocity_zero)
+            speed = std::uniform_int_distribution<>(0, fleet[vehicle_class].max_speed)(rng);
+        cars.emplace_back(vehicle_class, speed);
+        cars.back().position = indices[i];
+    }
+
+    // the index of a car is the cell of its rear on the shortened street, stretching the street again
+    // moves every car by the extra cells of the cars behind it
+    if (extra_cells > 0)
+    {
+        std::vector<Car *> order;
+        for (Car &car : cars)
+            order.push_back(&car);
+        std::sort(order.begin(), order.end(), [](const Car *a, const Car *b)
+                  { return a->position < b->position; });
+        int shift = 0;
+        for (Car *car : order)
+        {
+            shift += fleet[car->vehicle_class].length - 1;
+            car->position += shift;
         }
     }
+
+    // place the cars in all cells they occupy
+    for (Car &car : cars)
+    {
+        for (int j = 0; j < fleet[car.vehicle_class].length; j++)
+            street[(car.position - j + street.size()) % street.size()] = &car;
+    }
 }
 
 // ====================================================== //
 // ================= Computation-Methods ================ //
 // ====================================================== //
 
-/// @brief Accelerate the cars by 1 if their speed is below the max speed
+/// @brief Accelerate the cars by the acceleration of their class up to their max speed
 /// @param reading_street The street to read the cars from
 /// @param writing_street The street to write the updated cars to
 /// @param start_index The start index of the street section to accelerate the cars at
@@ -217,33 +739,24 @@ void SimulatorPeriodic::accelerate_cars(std::vector<Car *> &reading_street, std:
     if (start_index > end_index || end_index >= static_cast<int>(reading_street.size()) || start_index < 0)
         throw std::runtime_error("Error: Invalid start or end index for acceleration (from " + std::to_string(start_index) + " to " + std::to_string(end_index) + ") (Code: 101)");
 
+    const ClassParameters *classes = fleet.data();
     for (int i = start_index; i <= end_index; i++)
     {
         // check if the street is empty at this position
         if (!reading_street[i])
             continue;
 
-        if (reading_street[i]->speed == 0)
-            writing_street[i] = reading_street[i]; // if the car is already at speed 0, just move it to the writing street
+        // every cell of the car is moved to the writing street, but only the front updates the speed
+        writing_street[i] = reading_street[i];
+        if (!is_front(reading_street, i))
+            continue;
 
-        if (reading_street[i]->speed < reading_street[i]->max_speed)
-        {
-            // move the car p to the writing street
-            writing_street[i] = reading_street[i]; // Move the car to the writing street and delete it from the reading street
-            writing_street[i]->speed++;            // Accelerate the car
-        }
-        else if (reading_street[i]->speed == reading_street[i]->max_speed)
-        {
-            writing_street[i] = reading_street[i]; // if the car is already at max speed, just move it to the writing street
-        }
-        else
-        {
+        const ClassParameters &vehicle_class = classes[reading_street[i]->vehicle_class];
+        if (reading_street[i]->speed > vehicle_class.max_speed)
             throw std::runtime_error("Error: Speed of car is above max speed " + std::to_string(reading_street[i]->speed) + " (Code: 102)");
-        }
+        // Accelerate the car
+        writing_street[i]->speed = std::min(reading_street[i]->speed + vehicle_class.acceleration, vehicle_class.max_speed);
     }
-    // If the computation was successful, swap the reading and writing street adresses
-    std::swap(reading_street, writing_street);
-    std::fill(writing_street.begin(), writing_street.end(), nullptr);
 }
 
 /// @brief Decelerate the cars if they would collide with another car
@@ -263,6 +776,14 @@ void SimulatorPeriodic::decelerate_cars(std::vector<Car *> &reading_street, std:
         if (!reading_street[i])
             continue;
 
+        // only the front of a long vehicle has to look ahead and a standing car can not collide, just move them to the writing street
+        // (the front is checked first, the rear cells of a vehicle can lie in the section of another thread that writes its speed)
+        if (!is_front(reading_street, i) || reading_street[i]->speed == 0)
+        {
+            writing_street[i] = reading_street[i];
+            continue;
+        }
+
         // Iterate over the speed of the car and check if the car would collide with another car
         for (int distance = 1; distance <= reading_street[i]->speed; distance++)
         {
@@ -279,18 +800,16 @@ void SimulatorPeriodic::decelerate_cars(std::vector<Car *> &reading_street, std:
                 writing_street[i] = reading_street[i];
         }
     }
-    std::swap(reading_street, writing_street);
-    std::fill(writing_street.begin(), writing_street.end(), nullptr);
 }
 
-/// @brief decelerate cars by 1 with a certain probability
+/// @brief decelerate cars by 1 with the dawdle probability of their class
 /// @param reading_street Street to read the cars from
 /// @param writing_street Street to write the updated cars to
 /// @param start_index The start index of the street section to dawdle the cars at
 /// @param end_index The end index of the street section to dawdle the cars at
-/// @param dawdle_prob Probability to dawdle the car
+/// @param dawdle_prob Probability to dawdle the cars of the classes without their own probability
 /// @param rng Random number generator to generate the random numbers for the dawdle probability
-void SimulatorPeriodic::dawdle_cars(std::vector<Car *> &reading_street, std::vector<Car *> &writing_street, int start_index, int end_index, float dawdle_prob, std::mt19937 &rng)
+void SimulatorPeriodic::dawdle_cars(std::vector<Car *> &reading_street, std::vector<Car *> &writing_street, int start_index, int end_index, float dawdle_prob, CountingRng &rng)
 {
     if (start_index > end_index || end_index >= static_cast<int>(reading_street.size()) || start_index < 0)
         throw std::runtime_error("Error: Invalid start or end index for deceleration (from " + std::to_string(start_index) + " to " + std::to_string(end_index) + ") (Code: 105)");
@@ -298,13 +817,22 @@ void SimulatorPeriodic::dawdle_cars(std::vector<Car *> &reading_street, std::vec
     if (dawdle_prob < 0 || dawdle_prob > 1)
         throw std::runtime_error("Error: Invalid dawdle probability" + std::to_string(dawdle_prob) + " (Code: 106)");
 
+    const ClassParameters *classes = fleet.data();
     std::uniform_real_distribution<> dis(0, 1); // Generate a distribution from 0 to 1 to get a random number from
     for (int i = start_index; i <= end_index; i++)
     {
         if (!reading_street[i]) // check if the street is empty at this position, if yes -> continue
             continue;
-        // Check if the probability dawdle_prob is bigger than a random number between 0 and 1
-        if (dis(rng) < dawdle_prob && reading_street[i]->speed > 0) // if the car is not at speed 0, dawdle it
+        if (!is_front(reading_street, i)) // the other cells of a long vehicle are only moved to the writing street
+        {
+            writing_street[i] = reading_street[i];
+            continue;
+        }
+        float probability = classes[reading_street[i]->vehicle_class].dawdle_probability;
+        if (probability < 0)
+            probability = dawdle_prob;
+        // Check if the probability is bigger than a random number between 0 and 1
+        if (dis(rng) < probability && reading_street[i]->speed > 0) // if the car is not at speed 0, dawdle it
         {
             writing_street[i] = reading_street[i]; // Move the car to the writing street and delete it from the reading street
             writing_street[i]->speed--;            // Dawdle the car
@@ -314,8 +842,6 @@ void SimulatorPeriodic::dawdle_cars(std::vector<Car *> &reading_street, std::vec
             writing_street[i] = reading_street[i]; // if the car does not dawdle, just move it to the writing street
         }
     }
-    std::swap(reading_street, writing_street);
-    std::fill(writing_street.begin(), writing_street.end(), nullptr);
 }
 
 /// @brief Move the cars to their new position
@@ -330,37 +856,233 @@ void SimulatorPeriodic::move_cars(std::vector<Car *> &reading_street, std::vecto
         throw std::runtime_error("Error: Invalid start or end index for move (from " + std::to_string(start_index) + " to " + std::to_string(end_index) + ") (Code: 107)");
 
     // place the cars at their new position, make sure to move only cars that stay in the index range
+    const ClassParameters *classes = fleet.data();
+    int street_length = reading_street.size();
     for (int i = start_index; i <= end_index; i++)
     {
-        // check if the street is empty at this position
-        if (!reading_street[i])
+        // check if the street is empty at this position, a long vehicle is moved with all its cells from its front
+        if (!reading_street[i] || !is_front(reading_street, i))
             continue;
-        // check if there was a computation error in the previous steps
-        if (writing_street[(i + reading_street[i]->speed) % writing_street.size()] != nullptr) {
-            int collision_index = (i + reading_street[i]->speed) % writing_street.size(); 
-            throw std::runtime_error("Error: Car at position " + std::to_string(i) + "Speed: "+ std::to_string(reading_street[i]->speed) +" would collide with another car at: " + std::to_string(collision_index) + "(Code: 108)");
-        }
 
-        // move the car to the new position
-        writing_street[(i + reading_street[i]->speed) % reading_street.size()] = reading_street[i];
+        int position = (i + reading_street[i]->speed) % street_length;
+        for (int j = 0; j < classes[reading_street[i]->vehicle_class].length; j++)
+        {
+            int cell = (position - j + street_length) % street_length;
+            // check if there was a computation error in the previous steps
+            if (writing_street[cell] != nullptr)
+                throw std::runtime_error("Error: Car at position " + std::to_string(i) + "Speed: "+ std::to_string(reading_street[i]->speed) +" would collide with another car at: " + std::to_string(cell) + "(Code: 108)");
+            // move the car to the new position
+            writing_street[cell] = reading_street[i];
+        }
+        reading_street[i]->position = position;
     }
+}
+
+/// @brief Perform a whole step on the street of cells with the random number generator of the simulator
+void SimulatorPeriodic::step_cells()
+{
+    // accelerate the cars
+    accelerate_cars(reading_street, writing_street, 0, reading_street.size() - 1);
+    swap_streets();
+    // decelerate the cars
+    decelerate_cars(reading_street, writing_street, 0, reading_street.size() - 1);
+    swap_streets();
+    // dawdle the cars
+    dawdle_cars(reading_street, writing_street, 0, reading_street.size() - 1, parameters.dawdle_probability, rng);
+    swap_streets();
+    // move the cars
+    move_cars(reading_street, writing_street, 0, reading_street.size() - 1);
+    swap_streets();
+}
+
+/// @brief Swap the reading and writing street after a computation step and empty the new writing street
+void SimulatorPeriodic::swap_streets()
+{
     std::swap(reading_street, writing_street);
     std::fill(writing_street.begin(), writing_street.end(), nullptr);
 }
 
+/// @brief Perform a whole step on the car list, the cars are handled in the order of their position
+/// so the random numbers are drawn in the same order as in the cell engine
+/// @param rng Random number generator to generate the random numbers for the dawdle probability
+void SimulatorPeriodic::step_car_list(CountingRng &rng)
+{
+    int car_count = car_list.size();
+    int street_length = parameters.street_length;
+    const ClassParameters *classes = fleet.data();
+    std::uniform_real_distribution<> dis(0, 1);
+
+    // compute the new speeds, the gaps are computed from the old positions
+    for (int k = 0; k < car_count; k++)
+    {
+        Car *car = car_list[k];
+        const ClassParameters &vehicle_class = classes[car->vehicle_class];
+        // accelerate
+        car->speed = std::min(car->speed + vehicle_class.acceleration, vehicle_class.max_speed);
+        // decelerate to the gap to the rear of the next car (a single car never has to brake)
+        if (car_count > 1)
+        {
+            int next = k + 1 == car_count ? 0 : k + 1;
+            int gap = car_positions[next] - classes[car_list[next]->vehicle_class].length - car_positions[k];
+            if (gap < 0)
+                gap += street_length;
+            car->speed = std::min(car->speed, gap);
+        }
+        // dawdle
+        float probability = vehicle_class.dawdle_probability < 0 ? parameters.dawdle_probability : vehicle_class.dawdle_probability;
+        if (dis(rng) < probability && car->speed > 0)
+            car->speed--;
+    }
+
+    // move the cars and keep the street up to date
+    for (int k = 0; k < car_count; k++)
+    {
+        for (int j = 0; j < classes[car_list[k]->vehicle_class].length; j++)
+            reading_street[(car_positions[k] - j + street_length) % street_length] = nullptr;
+    }
+    int first = 0;
+    for (int k = 0; k < car_count; k++)
+    {
+        int position = (car_positions[k] + car_list[k]->speed) % street_length;
+        for (int j = 0; j < classes[car_list[k]->vehicle_class].length; j++)
+        {
+            int cell = (position - j + street_length) % street_length;
+            if (reading_street[cell])
+                throw std::runtime_error("Error: Car at position " + std::to_string(car_positions[k]) + " would collide with another car at: " + std::to_string(cell) + " (Code: 115)");
+            reading_street[cell] = car_list[k];
+        }
+        car_list[k]->position = position;
+        car_positions[k] = position;
+        // the cars that passed the end of the street are at the end of the list
+        if (k > 0 && position < car_positions[k - 1] && first == 0)
+            first = k;
+    }
+
+    // rotate the list so it starts with the car at the lowest position again
+    std::rotate(car_list.begin(), car_list.begin() + first, car_list.end());
+    std::rotate(car_positions.begin(), car_positions.begin() + first, car_positions.end());
+}
+
 // ====================================================== //
 // =================== Output-Methods =================== //
 // ====================================================== //
 
+/// @brief Method to open the output file once for the whole run (or use the stream set by the caller) and the image if requested
+void SimulatorPeriodic::open_output()
+{
+    const OutputOptions &options = parameters.output;
+    int window_end = options.window_end == -1 ? parameters.street_length : options.window_end;
+    if (options.time_stride <= 0 || options.space_stride <= 0 || options.window_start < 0 || window_end > parameters.street_length || options.window_start >= window_end)
+        throw std::runtime_error("Error: Invalid output window or stride (Code: 123)");
+
+    // the decimated row has one value per block of space_stride cells
+    output_row.resize((window_end - options.window_start + options.space_stride - 1) / options.space_stride);
+
+    if (!options.image_file_name.empty())
+    {
+        renderer = std::make_unique<SpaceTimeRenderer>(options.image_file_name, output_row.size(), parameters.iterations / options.time_stride + 1, fleet.get_max_speed());
+    }
+
+    if (parameters.jams.enabled)
+    {
+        // the jam statistics are written next to the output file if no file name is given
+        JamOptions jam_options = parameters.jams;
+        if (jam_options.file_name.empty())
+        {
+            std::filesystem::path jam_file = parameters.output_file_name;
+            jam_file.replace_filename(jam_file.stem().string() + "_jams.csv");
+            jam_options.file_name = jam_file.string();
+        }
+        jam_tracker = std::make_unique<JamTracker>(jam_options, parameters.street_length);
+    }
+
+    if (parameters.keyframes.interval > 0)
+    {
+        // the keyframes are written next to the output file if no file name is given
+        std::string keyframe_file = parameters.keyframes.file_name;
+        if (keyframe_file.empty())
+        {
+            std::filesystem::path path = parameters.output_file_name;
+            path.replace_filename(path.stem().string() + "_keyframes.bin");
+            keyframe_file = path.string();
+        }
+        keyframe_store = std::make_unique<KeyframeStore>(keyframe_file, parameters, used_seed, parameters.keyframes.interval);
+    }
+
+    if (!options.csv)
+        output_stream = nullptr;
+    else if (external_output_stream)
+        output_stream = external_output_stream;
+    else
+    {
+        output_file.open(parameters.output_file_name, std::ios::trunc);
+
+        // check if the file could be opened
+        if (!output_file.is_open())
+            throw std::runtime_error("Error: Could not open output file (Code: 110)");
+        output_stream = &output_file;
+    }
+}
+
+/// @brief Method to flush the results and close the output file and the image
+void SimulatorPeriodic::close_output()
+{
+    if (output_stream)
+        output_stream->flush();
+    if (output_file.is_open())
+        output_file.close();
+    output_stream = nullptr;
+    if (renderer)
+        renderer->finish();
+    renderer.reset();
+    if (jam_tracker)
+        jam_tracker->finish();
+    jam_tracker.reset();
+    keyframe_store.reset();
+}
+
+/// @brief Method to reduce the street to the output window, combining space_stride cells into one value
+/// @param street The street to reduce, the result is stored in output_row
+void SimulatorPeriodic::decimate_street(std::vector<Car *> &street)
+{
+    const OutputOptions &options = parameters.output;
+    int window_end = options.window_end == -1 ? parameters.street_length : options.window_end;
+
+    for (size_t block = 0; block < output_row.size(); block++)
+    {
+        int start = options.window_start + block * options.space_stride;
+        int end = std::min(start + options.space_stride, window_end);
+
+        // aggregate the speeds of the cars in the block, a block without cars stays empty
+        int cars = 0;
+        float value = EMPTY;
+        for (int i = start; i < end; i++)
+        {
+            if (!street[i])
+                continue;
+            float speed = static_cast<float>(street[i]->speed);
+            if (cars == 0)
+                value = speed;
+            else if (options.aggregation == Aggregation::MIN)
+                value = std::min(value, speed);
+            else if (options.aggregation == Aggregation::MAX)
+                value = std::max(value, speed);
+            else
+                value += speed;
+            cars++;
+        }
+        if (options.aggregation == Aggregation::MEAN && cars > 1)
+            value /= cars;
+        output_row[block] = value;
+    }
+}
+
 /// @brief Method to print the parameters of the simulation to the file
 void SimulatorPeriodic::print_parameters()
 {
-    // open the output file in append mode
-    std::ofstream file(parameters.output_file_name, std::ios::app);
-
-    // check if the file could be opened
-    if (!file.is_open())
-        throw std::runtime_error("Error: Could not open output file (Code: 110)");
+    if (!output_stream)
+        return;
+    std::ostream &file = *output_stream;
 
     // write the parameters of the simulation to the file
     file << "Street Length: " << parameters.street_length << ", "
@@ -369,41 +1091,71 @@ void SimulatorPeriodic::print_parameters()
          << "Iterations: " << parameters.iterations << ", "
          << "Dawdle Probability: " << parameters.dawdle_probability << ", "
          << "Unlimited Speed: " << (parameters.always_unlimited ? "Yes, " : "No, ")
-         << "Cars start with speed 0:" << (parameters.start_velocity_zero ? "Yes" : "No") << "\n";
+         << "Cars start with speed 0:" << (parameters.start_velocity_zero ? "Yes" : "No");
+
+    // the seed is only written if it was given, so the run can be repeated
+    if (parameters.seed >= 0)
+        file << ", Seed: " << parameters.seed;
 
-    // close the file
-    file.close();
+    // the engine is only written if it was chosen explicitly or by the autotuner
+    if (!parameters.engine_report.empty())
+        file << ", Engine: " << parameters.engine_report;
+
+    // the fleet is only written if it was given, as "<name> <share> <max_speed> <dawdle_probability> <acceleration> <length>" per class
+    if (!parameters.vehicle_classes.empty())
+    {
+        file << ", Fleet:";
+        for (const VehicleClass &vehicle_class : parameters.vehicle_classes)
+        {
+            file << (&vehicle_class == &parameters.vehicle_classes.front() ? " " : "; ") << vehicle_class.name << " " << vehicle_class.share << " " << vehicle_class.max_speed << " ";
+            if (vehicle_class.dawdle_probability < 0)
+                file << "-";
+            else
+                file << vehicle_class.dawdle_probability;
+            file << " " << vehicle_class.acceleration << " " << vehicle_class.length;
+        }
+    }
+
+    // the decimation is only written if it is used, so the header of full outputs stays unchanged
+    const OutputOptions &options = parameters.output;
+    if (options.time_stride != 1 || options.space_stride != 1 || options.window_start != 0 || options.window_end != -1)
+    {
+        static const char *aggregation_names[] = {"min", "mean", "max"};
+        file << ", Time Stride: " << options.time_stride
+             << ", Window: " << options.window_start << "-" << (options.window_end == -1 ? parameters.street_length : options.window_end)
+             << ", Space Stride: " << options.space_stride
+             << ", Aggregation: " << aggregation_names[static_cast<int>(options.aggregation)];
+    }
+    file << "\n";
 }
 
-/// @brief Method to write the current state of the street to a file
+/// @brief Method to write the current state of the street to the file and the image
 /// @param street The street to write to the file
 void SimulatorPeriodic::print_street(std::vector<Car *> &street)
 {
-    // open the output file in append mode
-    std::ofstream file(parameters.output_file_name, std::ios::app);
+    decimate_street(street);
 
-    // check if the file could be opened
-    if (!file.is_open())
-        throw std::runtime_error("Error: Could not open output file (Code: 109)");
+    if (renderer)
+        renderer->write_row(output_row);
+    if (!output_stream)
+        return;
+    std::ostream &file = *output_stream;
 
     // write the current state of the street to the file
-    for (size_t i = 0; i < street.size(); i++)
+    for (size_t i = 0; i < output_row.size(); i++)
     {
-        if (!street[i])
-            // Write a "-" if the cell is empty (nullptr)
+        if (output_row[i] == EMPTY)
+            // Write a "-" if the cell is empty
             file << "-";
         else
-            // Otherwise, write the car's speed
-            file << street[i]->speed;
+            // Otherwise, write the (aggregated) speed
+            file << output_row[i];
 
         // Separate the cars with a comma, except for the last car
-        if (i != street.size() - 1)
+        if (i != output_row.size() - 1)
             file << ",";
     }
 
     // Add a newline character at the end of the line
-    file << std::endl;
-
-    // close the file
-    file.close();
+    file << "\n";
 }
\ No newline at end of file
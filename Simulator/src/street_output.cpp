@@ -0,0 +1,85 @@
+#include "../include/street_output.h"
+#include "../include/simulator_base.h"
+#include <algorithm>
+#include <stdexcept>
+
+// #################################################################### //
+// ##################### CONSTRUCTOR & DESTRUCTOR ##################### //
+// #################################################################### //
+
+/// @brief Constructor to open the image and write its header
+/// @param file_name Name of the image, ".ppm" files are written in color, all other files as grayscale PGM
+/// @param width Number of values per row
+/// @param height Number of rows
+/// @param max_speed Speed that is drawn with the lightest color
+SpaceTimeRenderer::SpaceTimeRenderer(const std::string &file_name, int width, int height, int max_speed)
+    : width(width), height(height), max_speed(static_cast<float>(std::max(1, max_speed)))
+{
+    if (width <= 0 || height <= 0)
+        throw std::runtime_error("Error: Invalid image size " + std::to_string(width) + "x" + std::to_string(height) + " (Code: 120)");
+
+    color = file_name.size() >= 4 && file_name.compare(file_name.size() - 4, 4, ".ppm") == 0;
+    file.open(file_name, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        throw std::runtime_error("Error: Could not open image file " + file_name + " (Code: 121)");
+
+    file << (color ? "P6" : "P5") << "\n"
+         << width << " " << height << "\n255\n";
+    pixels.resize(static_cast<size_t>(width) * (color ? 3 : 1));
+}
+
+/// @brief Destructor to make sure the image is complete
+SpaceTimeRenderer::~SpaceTimeRenderer()
+{
+    finish();
+}
+
+// ##################################################################### //
+// ############################## METHODS ############################## //
+// ##################################################################### //
+
+/// @brief Method to append one row of the diagram
+/// @param row The (aggregated) speeds of the row, EMPTY marks an empty cell
+void SpaceTimeRenderer::write_row(const std::vector<float> &row)
+{
+    if (static_cast<int>(row.size()) != width)
+        throw std::runtime_error("Error: Row has " + std::to_string(row.size()) + " values but the image is " + std::to_string(width) + " wide (Code: 122)");
+    if (rows_written >= height)
+        return;
+
+    for (int i = 0; i < width; i++)
+    {
+        if (row[i] == EMPTY)
+        {
+            // empty cells are white
+            std::fill_n(pixels.begin() + i * (color ? 3 : 1), color ? 3 : 1, 255);
+            continue;
+        }
+        float relative_speed = std::min(1.0f, row[i] / max_speed);
+        if (color)
+        {
+            // red for standing cars over yellow to green for cars at max speed
+            pixels[3 * i] = static_cast<unsigned char>(relative_speed < 0.5f ? 220 : 220 * (1.0f - relative_speed) * 2);
+            pixels[3 * i + 1] = static_cast<unsigned char>(relative_speed < 0.5f ? 180 * relative_speed * 2 : 180);
+            pixels[3 * i + 2] = 0;
+        }
+        else
+        {
+            // black for standing cars up to light gray for cars at max speed
+            pixels[i] = static_cast<unsigned char>(200 * relative_speed);
+        }
+    }
+    file.write(reinterpret_cast<const char *>(pixels.data()), pixels.size());
+    rows_written++;
+}
+
+/// @brief Method to fill the missing rows with empty cells and close the image
+void SpaceTimeRenderer::finish()
+{
+    if (!file.is_open())
+        return;
+    std::fill(pixels.begin(), pixels.end(), 255);
+    for (; rows_written < height; rows_written++)
+        file.write(reinterpret_cast<const char *>(pixels.data()), pixels.size());
+    file.close();
+}
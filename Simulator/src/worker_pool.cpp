@@ -0,0 +1,75 @@
+#include "../include/worker_pool.h"
+
+// ##################################################################### //
+// ###################### CONSTRUCTOR & DESTRUCTOR ##################### //
+// ##################################################################### //
+
+/// @brief Constructor to start the threads of the pool
+/// @param thread_count Number of threads a task runs on, the calling thread of run is one of them
+WorkerPool::WorkerPool(int thread_count)
+{
+    for (int t = 1; t < thread_count; t++)
+        threads.emplace_back(&WorkerPool::work, this, t);
+}
+
+/// @brief Destructor to stop and join the threads, no task may be running
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        shutdown = true;
+    }
+    task_ready.notify_all();
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+// ##################################################################### //
+// ############################## METHODS ############################## //
+// ##################################################################### //
+
+/// @brief Method to run a task on all threads, the calling thread runs index 0
+/// @param task Function called with the index of the thread, it must not throw
+void WorkerPool::run(const std::function<void(int)> &task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = &task;
+        busy = threads.size();
+        generation++;
+    }
+    task_ready.notify_all();
+
+    task(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    task_done.wait(lock, [this]
+                   { return busy == 0; });
+    this->task = nullptr;
+}
+
+/// @brief Method run by every thread of the pool, waits for the tasks and runs them
+/// @param thread_index The index the tasks are called with
+void WorkerPool::work(int thread_index)
+{
+    unsigned long finished_generation = 0;
+    while (true)
+    {
+        const std::function<void(int)> *current_task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            task_ready.wait(lock, [this, finished_generation]
+                            { return shutdown || generation != finished_generation; });
+            if (shutdown)
+                return;
+            finished_generation = generation;
+            current_task = task;
+        }
+
+        (*current_task)(thread_index);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy == 0)
+            task_done.notify_one();
+    }
+}